@@ -0,0 +1,76 @@
+#ifndef BENCHMARK_ALLOC_COUNTER_H
+#define BENCHMARK_ALLOC_COUNTER_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+/* 替换全局的 operator new/delete（包括数组和带对齐参数的版本），
+ * 统计堆分配的次数和字节数。只在基准测试里 include，不要放进库的头文件。 */
+namespace alloc_counter {
+inline size_t g_count = 0; /*分配次数*/
+inline size_t g_bytes = 0; /*分配的字节数*/
+} // namespace alloc_counter
+
+/* 这些 operator delete 本身就是用 free 实现的，GCC 内联之后会把它们当成
+ * new 出来的指针被 free，报 -Wmismatched-new-delete，这里是误报 */
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void *operator new(size_t size) {
+  alloc_counter::g_count++;
+  alloc_counter::g_bytes += size;
+  if (void *p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+void *operator new[](size_t size) { return ::operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+/* pmr 的 new_delete_resource 走的是带对齐参数的版本，也要统计 */
+void *operator new(size_t size, std::align_val_t align) {
+  alloc_counter::g_count++;
+  alloc_counter::g_bytes += size;
+  auto al = static_cast<size_t>(align);
+  if (void *p = std::aligned_alloc(al, (size + al - 1) / al * al))
+    return p;
+  throw std::bad_alloc();
+}
+void *operator new[](size_t size, std::align_val_t align) {
+  return ::operator new(size, align);
+}
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+/* 和 Timer 一样是 RAII 的，出作用域打印这段时间内的分配次数 */
+class AllocCounter {
+public:
+  AllocCounter()
+      : m_count(alloc_counter::g_count), m_bytes(alloc_counter::g_bytes) {}
+
+  ~AllocCounter() { Stop(); }
+
+  void Stop() {
+    printf("%zu allocs (%zu bytes)\n", alloc_counter::g_count - m_count,
+           alloc_counter::g_bytes - m_bytes);
+    fflush(stdout);
+  }
+
+private:
+  size_t m_count;
+  size_t m_bytes;
+};
+
+#endif // BENCHMARK_ALLOC_COUNTER_H
@@ -0,0 +1,153 @@
+#ifndef BENCHMARK_BENCH_H
+#define BENCHMARK_BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/* 替代 Timer 的基准测试工具：先预热，再重复运行到足够的次数和时间，
+ * 报告最小值、中位数、p99 和 MB/s，结果可以写成 JSON 或 CSV，
+ * 用来和上一个版本的结果比较。 */
+namespace bench {
+struct Options {
+  int warmup = 2;           /*预热的次数，不计入结果*/
+  int min_runs = 10;        /*至少运行的次数*/
+  int max_runs = 1000;      /*最多运行的次数*/
+  double min_seconds = 0.5; /*至少运行多久（包括 f 里没有量的部分）*/
+};
+
+struct Result {
+  std::string file;
+  std::string name;
+  size_t bytes = 0; /*每次处理的字节数，用来算 MB/s*/
+  size_t runs = 0;
+  double min = 0, median = 0, p99 = 0, mean = 0; /*秒*/
+  double mb_per_s() const {
+    return median > 0 ? double(bytes) / median / (1024 * 1024) : 0;
+  }
+};
+
+inline double now() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/* 让编译器认为 value 被用到了，不会把要测的代码整个优化掉 */
+template <class T> inline void keep(T const &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r"(&value) : "memory");
+#else
+  static const void *volatile sink;
+  sink = &value;
+#endif
+}
+
+/**
+ * 运行一次 f 的耗时：f 返回 double 时就是它自己量的时间（比如只量析构那一段），
+ * 否则量整个调用
+ */
+template <class F> double sample(F &f) {
+  if constexpr (std::is_same_v<std::invoke_result_t<F &>, double>) {
+    return f();
+  } else {
+    double start = now();
+    f();
+    return now() - start;
+  }
+}
+
+/* 排好序的样本的第 p 分位（nearest-rank） */
+inline double percentile(std::vector<double> const &sorted, double p) {
+  size_t rank = size_t(std::ceil(p * double(sorted.size())));
+  return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+/**
+ * 预热之后重复运行 f，直到次数和总时间都够了
+ * @param file 测的是哪个文件
+ * @param name 测的是什么
+ * @param bytes 每次处理的字节数
+ * @param f
+ * @param options
+ * @return
+ */
+template <class F>
+Result run(std::string file, std::string name, size_t bytes, F &&f,
+           Options const &options = {}) {
+  for (int i = 0; i < options.warmup; i++)
+    sample(f);
+  std::vector<double> times;
+  double total = 0, start = now();
+  while ((int(times.size()) < options.min_runs ||
+          now() - start < options.min_seconds) &&
+         int(times.size()) < options.max_runs) {
+    times.push_back(sample(f));
+    total += times.back();
+  }
+  std::sort(times.begin(), times.end());
+  Result result;
+  result.file = std::move(file);
+  result.name = std::move(name);
+  result.bytes = bytes;
+  result.runs = times.size();
+  result.min = times.front();
+  result.median = percentile(times, 0.5);
+  result.p99 = percentile(times, 0.99);
+  result.mean = total / double(times.size());
+  return result;
+}
+
+/* 表格形式打印一行，时间用毫秒 */
+inline void print_header() {
+  printf("%-24s %-28s %6s %10s %10s %10s %10s\n", "file", "name", "runs",
+         "min(ms)", "median(ms)", "p99(ms)", "MB/s");
+}
+inline void print(Result const &r) {
+  printf("%-24s %-28s %6zu %10.3f %10.3f %10.3f %10.1f\n", r.file.c_str(),
+         r.name.c_str(), r.runs, r.min * 1e3, r.median * 1e3, r.p99 * 1e3,
+         r.mb_per_s());
+  fflush(stdout);
+}
+
+/* 名字里只可能有普通字符，只处理 " 和 \ */
+inline std::string quote(std::string const &str) {
+  std::string out = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\')
+      out += '\\';
+    out += c;
+  }
+  return out + "\"";
+}
+
+/* 写成 JSON 数组，每个结果一个 dict，时间的单位是秒 */
+inline void write_json(FILE *out, std::vector<Result> const &results) {
+  fprintf(out, "[\n");
+  for (size_t i = 0; i < results.size(); i++) {
+    Result const &r = results[i];
+    fprintf(out,
+            "  {\"file\": %s, \"name\": %s, \"bytes\": %zu, \"runs\": %zu, "
+            "\"min\": %.9f, \"median\": %.9f, \"p99\": %.9f, \"mean\": %.9f, "
+            "\"mb_per_s\": %.3f}%s\n",
+            quote(r.file).c_str(), quote(r.name).c_str(), r.bytes, r.runs,
+            r.min, r.median, r.p99, r.mean, r.mb_per_s(),
+            i + 1 < results.size() ? "," : "");
+  }
+  fprintf(out, "]\n");
+}
+
+inline void write_csv(FILE *out, std::vector<Result> const &results) {
+  fprintf(out, "file,name,bytes,runs,min,median,p99,mean,mb_per_s\n");
+  for (Result const &r : results)
+    fprintf(out, "%s,%s,%zu,%zu,%.9f,%.9f,%.9f,%.9f,%.3f\n", r.file.c_str(),
+            r.name.c_str(), r.bytes, r.runs, r.min, r.median, r.p99, r.mean,
+            r.mb_per_s());
+}
+} // namespace bench
+
+#endif // BENCHMARK_BENCH_H
@@ -4,6 +4,8 @@
 #include <chrono>
 #include <iostream>
 
+/* 出作用域时打印一次耗时，只适合在示例里粗略看一眼；
+ * 一次的读数受预热、噪声影响很大，基准测试用 Bench.h */
 class Timer {
 public:
   Timer() { m_StartTimepoint = std::chrono::high_resolution_clock::now(); }
@@ -0,0 +1,690 @@
+#ifndef MYJSON_PARSER_DICT_H
+#define MYJSON_PARSER_DICT_H
+
+#include "Scanner.h"
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <compare>
+#include <concepts>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace json {
+/*
+ ======================================================================
+ |                         DictKey 类定义开始                          |
+ ======================================================================
+ */
+/**
+ * dict 的 key，16 字节，有三种存法：
+ *   不超过 8 个字节的直接放在指针的位置上，不用分配内存；
+ *   更长的拷贝一份放在堆上，析构时释放；
+ *   借用的（Ref）只记住指针，比如 intern 表里的 key 或者 arena 里的 key，
+ *   这时多个 dict 的同一个 key 共用一份内存，比较时指针相同就不用再比较内容了。
+ * 和 JObject 一样，拷贝出来的 key 总是拥有自己的数据。
+ */
+class DictKey {
+public:
+  static constexpr size_t inline_size = 8;
+
+  DictKey() = default;
+  /* 拷贝一份 key，和 std::string 一样可以从字符串隐式构造 */
+  DictKey(std::string_view key) { assign(key); }
+  DictKey(const char *key) : DictKey(std::string_view(key)) {}
+  /**
+   * 借用外部的字符串，不拷贝。调用者必须保证它活得比这个 key 久
+   * @param key
+   */
+  static DictKey Ref(std::string_view key) {
+    DictKey ret;
+    ret.m_ptr = key.data();
+    ret.m_len = check_len(key);
+    ret.m_borrowed = true;
+    return ret;
+  }
+  DictKey(DictKey const &other) { assign(other.view()); }
+  DictKey(DictKey &&other) noexcept { take(other); }
+  DictKey &operator=(DictKey const &other) {
+    if (this != &other) {
+      DictKey tmp(other);
+      release();
+      take(tmp);
+    }
+    return *this;
+  }
+  DictKey &operator=(DictKey &&other) noexcept {
+    if (this != &other) {
+      release();
+      take(other);
+    }
+    return *this;
+  }
+  ~DictKey() { release(); }
+
+  /* 数据在堆上、由自己释放（不是借用的，也没有直接放在 key 里） */
+  bool on_heap() const { return !m_borrowed && m_len > inline_size; }
+  const char *data() const { return is_inline() ? m_buf : m_ptr; }
+  size_t size() const { return m_len; }
+  bool empty() const { return m_len == 0; }
+  std::string_view view() const { return {data(), m_len}; }
+  operator std::string_view() const { return view(); }
+
+  /* 指针相同（比如都来自同一个 intern 表）时不用再比较内容 */
+  friend bool operator==(DictKey const &lhs, std::string_view rhs) {
+    return lhs.m_len == rhs.size() &&
+           (lhs.data() == rhs.data() || rhs.empty() ||
+            std::memcmp(lhs.data(), rhs.data(), rhs.size()) == 0);
+  }
+
+private:
+  static uint32_t check_len(std::string_view key) {
+    if (key.size() > UINT32_MAX)
+      throw std::length_error("key too long in dict");
+    return static_cast<uint32_t>(key.size());
+  }
+  bool is_inline() const { return !m_borrowed && m_len <= inline_size; }
+  void assign(std::string_view key) {
+    m_len = check_len(key);
+    char *data = m_buf;
+    if (m_len > inline_size)
+      data = new char[m_len];
+    else
+      std::memset(m_buf, 0, inline_size);
+    if (m_len)
+      std::memcpy(data, key.data(), m_len);
+    if (m_len > inline_size)
+      m_ptr = data;
+  }
+  void release() {
+    if (!m_borrowed && m_len > inline_size)
+      delete[] m_ptr;
+    m_ptr = nullptr;
+    m_len = 0;
+    m_borrowed = false;
+  }
+  /* 整个拿过来，other 变成空的 */
+  void take(DictKey &other) {
+    std::memcpy(m_buf, other.m_buf, inline_size);
+    m_len = other.m_len;
+    m_borrowed = other.m_borrowed;
+    other.m_ptr = nullptr;
+    other.m_len = 0;
+    other.m_borrowed = false;
+  }
+
+  union {
+    const char *m_ptr{nullptr};
+    char m_buf[inline_size];
+  };
+  uint32_t m_len{};
+  bool m_borrowed{false};
+};
+static_assert(sizeof(DictKey) <= 16, "DictKey should stay 16 bytes");
+/*
+ ======================================================================
+ |                         DictKey 类定义结束                          |
+ ======================================================================
+ */
+using dict_key_t = DictKey;
+/* 预先算好 hash 的 key：反复查找同一个 key 时（见 Pointer.h）不用每次都重新 hash */
+struct hashed_key {
+  std::string_view key;
+  size_t hash;
+  explicit hashed_key(std::string_view key)
+      : key(key), hash(std::hash<std::string_view>{}(key)) {}
+  hashed_key(std::string_view key, size_t hash) : key(key), hash(hash) {}
+};
+/*
+ ======================================================================
+ |                        basic_dict 类定义开始                         |
+ ======================================================================
+ */
+/**
+ * JSON 的 dict：键值对（DictKey 和值）放在 dict 自己管理的几块连续内存里
+ * （块的大小翻倍增长，reserve 过的话一块就够），每一块的末尾还有一个按插入的顺序
+ * 指向所有键值对的指针数组（只用最后一块的），所以遍历（以及序列化的输出）的顺序
+ * 和输入的顺序一样，而 reserve 过的 dict 只分配一次内存。
+ * 插入时已有的键值对不会移动，和 unordered_map 一样，值的引用在插入之后依然有效
+ * （d[new] = d[old] 的右边不会因为插入而失效）；删除只移动指针，只有被删掉的那个失效，
+ * 它占的位置不再复用，clear 或者析构时才一起释放。
+ * key 不超过 small_size 个时不建索引，查找就是从头比较一遍，连 hash 都不用算；
+ * 超过之后再建一个开放寻址的索引：槽位 16 个一组，每个槽位一个控制字节
+ * （空位或者 hash 的高 7 位），一次用 SSE2 比较一组的 16 个控制字节，
+ * 控制字节和槽位里缓存的 hash 都对上时才真正比较 key，扩容时也不用重新算 hash。
+ * 删除很少见，删除之后直接重建索引，所以索引里没有墓碑。
+ * 和 std::map 一样，迭代器看到的是 std::pair<const dict_key_t, V>，key 不能修改
+ * （改了索引就对不上了）。
+ * @tparam V 值的类型，也就是 JObject
+ */
+template <class V> class basic_dict {
+public:
+  using key_type = dict_key_t;
+  using mapped_type = V;
+  using value_type = std::pair<const dict_key_t, V>;
+  using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+  /* 按插入顺序遍历指针数组，解引用两次得到键值对 */
+  template <bool Const> class Iterator {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = basic_dict::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, value_type const *, value_type *>;
+    using reference = std::conditional_t<Const, value_type const &, value_type &>;
+
+    Iterator() = default;
+    explicit Iterator(value_type *const *pos) : m_pos(pos) {}
+    /* iterator 可以转成 const_iterator */
+    template <bool C = Const, class = std::enable_if_t<C>>
+    Iterator(Iterator<false> other) : m_pos(other.base()) {}
+
+    value_type *const *base() const { return m_pos; }
+    reference operator*() const { return **m_pos; }
+    pointer operator->() const { return *m_pos; }
+    reference operator[](difference_type n) const { return *m_pos[n]; }
+    Iterator &operator++() { ++m_pos; return *this; }
+    Iterator &operator--() { --m_pos; return *this; }
+    Iterator operator++(int) { return Iterator(m_pos++); }
+    Iterator operator--(int) { return Iterator(m_pos--); }
+    Iterator &operator+=(difference_type n) { m_pos += n; return *this; }
+    Iterator &operator-=(difference_type n) { m_pos -= n; return *this; }
+    friend Iterator operator+(Iterator it, difference_type n) { return it += n; }
+    friend Iterator operator+(difference_type n, Iterator it) { return it += n; }
+    friend Iterator operator-(Iterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(Iterator lhs, Iterator rhs) {
+      return lhs.m_pos - rhs.m_pos;
+    }
+    friend bool operator==(Iterator lhs, Iterator rhs) {
+      return lhs.m_pos == rhs.m_pos;
+    }
+    friend auto operator<=>(Iterator lhs, Iterator rhs) {
+      return lhs.m_pos <=> rhs.m_pos;
+    }
+
+  private:
+    value_type *const *m_pos{nullptr};
+  };
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+  static constexpr size_t small_size = 8;
+
+  basic_dict() = default;
+  /* 所有的数据（包括索引）都从 alloc 里分配，比如 Document 的 arena */
+  explicit basic_dict(allocator_type alloc) : m_groups(alloc) {}
+  /* 和 pmr 容器一样，拷贝出来的 dict 换回默认的堆分配 */
+  basic_dict(basic_dict const &other) : m_groups(other.m_groups) {
+    append_all(other);
+  }
+  basic_dict(basic_dict &&other) noexcept
+      : m_block(std::exchange(other.m_block, nullptr)),
+        m_size(std::exchange(other.m_size, 0)),
+        m_groups(std::move(other.m_groups)) {}
+  /* 和 pmr 容器一样，赋值不改变自己的 allocator */
+  basic_dict &operator=(basic_dict const &other);
+  basic_dict &operator=(basic_dict &&other);
+  ~basic_dict() { clear(); }
+
+  allocator_type get_allocator() const {
+    return allocator_type(m_groups.get_allocator().resource());
+  }
+
+  iterator begin() { return iterator(entries()); }
+  iterator end() { return begin() + m_size; }
+  const_iterator begin() const { return const_iterator(entries()); }
+  const_iterator end() const { return begin() + m_size; }
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+  void reserve(size_t n);
+  void clear();
+
+  iterator find(std::string_view key) { return begin() + index_of(key); }
+  const_iterator find(std::string_view key) const {
+    return begin() + index_of(key);
+  }
+  iterator find(hashed_key const &key) { return begin() + index_of(key); }
+  const_iterator find(hashed_key const &key) const {
+    return begin() + index_of(key);
+  }
+  bool contains(std::string_view key) const { return find(key) != end(); }
+  size_t count(std::string_view key) const { return contains(key) ? 1 : 0; }
+
+  V &at(std::string_view key);
+  V const &at(std::string_view key) const {
+    return const_cast<basic_dict *>(this)->at(key);
+  }
+  /* 和 map[] 一样，找不到时插入一个默认的值 */
+  V &operator[](std::string_view key) {
+    return try_emplace(key).first->second;
+  }
+
+  /**
+   * key 不存在时在末尾插入 {key, V(args...)}，存在时什么都不做
+   * @param key DictKey 直接移动进来（借用的 key 还是借用），
+   *            string_view 等只在插入时才构造 key（见 make_key）
+   * @return 指向这个 key 的迭代器，以及是否插入了
+   */
+  template <class K, class... Args>
+    requires std::convertible_to<K const &, std::string_view>
+  std::pair<iterator, bool> try_emplace(K &&key, Args &&...args) {
+    std::string_view view(key);
+    /*还没有索引时用不到 hash，不用算*/
+    return try_emplace(indexed() ? hashed_key(view) : hashed_key(view, 0),
+                       std::forward<K>(key), std::forward<Args>(args)...);
+  }
+  /**
+   * 和上面一样，但是 hash 已经算好了（比如刚用它 find 过，见 Intern.h），不用再算一次
+   * @param hashed key 的内容和 hash，内容必须和 key 一样
+   */
+  template <class K, class... Args>
+  std::pair<iterator, bool> try_emplace(hashed_key const &hashed, K &&key,
+                                        Args &&...args);
+  /* key 不存在时在末尾插入，存在时在原来的位置上覆盖值（顺序不变） */
+  template <class K>
+  std::pair<iterator, bool> insert_or_assign(K &&key, V value) {
+    auto ret = try_emplace(std::forward<K>(key), std::move(value));
+    if (!ret.second) /*没有插入的话 value 还没有被移动过*/
+      ret.first->second = std::move(value);
+    return ret;
+  }
+  size_t erase(std::string_view key);
+
+private:
+  static constexpr size_t group_size = 16;
+  static constexpr uint8_t empty_ctrl = 0x80;
+  static constexpr size_t npos = size_t(-1);
+  /* 一组槽位：控制字节连续地放在开头，一条 SSE2 指令就能比较完 */
+  struct Group {
+    uint8_t ctrl[group_size];
+    uint32_t index[group_size]; /* 键值对在 entries() 里的下标 */
+    size_t hash[group_size];    /* 这个 key 的 hash */
+    Group() { std::memset(ctrl, empty_ctrl, group_size); }
+  };
+  /**
+   * 一块内存的开头：后面依次是 capacity 个键值对的位置（只在末尾追加）
+   * 和 order_capacity 个指针。order_capacity 是到这一块为止所有块的 capacity 之和，
+   * 所以最后一块的指针数组总是放得下所有的键值对
+   */
+  struct Block {
+    Block *prev; /* 上一块，释放时用 */
+    uint32_t capacity;
+    uint32_t used; /* 已经用过的位置，删掉的也算 */
+    uint32_t order_capacity;
+
+    static constexpr size_t align =
+        std::max({alignof(Block), alignof(value_type), alignof(value_type *)});
+    static constexpr size_t data_offset =
+        (sizeof(Block) + alignof(value_type) - 1) / alignof(value_type) *
+        alignof(value_type);
+    static size_t order_offset(size_t capacity) {
+      size_t end = data_offset + capacity * sizeof(value_type);
+      return (end + alignof(value_type *) - 1) / alignof(value_type *) *
+             alignof(value_type *);
+    }
+    static size_t bytes(size_t capacity, size_t order_capacity) {
+      return order_offset(capacity) + order_capacity * sizeof(value_type *);
+    }
+    value_type *data() {
+      return reinterpret_cast<value_type *>(reinterpret_cast<char *>(this) +
+                                            data_offset);
+    }
+    value_type **order() {
+      return reinterpret_cast<value_type **>(reinterpret_cast<char *>(this) +
+                                             order_offset(capacity));
+    }
+  };
+
+  static size_t hash_of(std::string_view key) {
+    return std::hash<std::string_view>{}(key);
+  }
+  /* 控制字节：hash 的高 7 位，最高位留给空位 */
+  static uint8_t tag_of(size_t hash) {
+    return uint8_t(hash >> (sizeof(size_t) * 8 - 7));
+  }
+  static uint32_t match(Group const &group, uint8_t ctrl);
+  bool indexed() const { return !m_groups.empty(); }
+  /* 按插入顺序排列的键值对的指针，在最后一块的末尾 */
+  value_type **entries() const { return m_block ? m_block->order() : nullptr; }
+
+  size_t linear_find(std::string_view key) const;
+  size_t lookup(hashed_key const &key) const;
+  size_t index_of(std::string_view key) const {
+    return indexed() ? lookup(hashed_key(key)) : linear_find(key);
+  }
+  size_t index_of(hashed_key const &key) const {
+    return indexed() ? lookup(key) : linear_find(key.key);
+  }
+  DictKey make_key(std::string_view key) const;
+  void add_block(size_t capacity);
+  template <class... Args> void append(Args &&...args);
+  void append_all(basic_dict const &other);
+  void inserted(size_t hash);
+  void index_insert(uint32_t index, size_t hash);
+  void rebuild_index(size_t groups, size_t erased = npos);
+
+  Block *m_block{nullptr}; /* 最后一块，没有分配过时为空 */
+  size_t m_size{0};
+  std::pmr::vector<Group> m_groups; /* 索引，组数是 2 的幂，没有索引时为空；
+                                       dict 的 allocator 也记在这里 */
+};
+/*
+ ======================================================================
+ |                        basic_dict 类定义结束                         |
+ ======================================================================
+ */
+
+/**
+ * 一组 16 个控制字节里哪些等于 ctrl
+ * @return 第 i 位对应这组的第 i 个槽位
+ */
+template <class V>
+inline uint32_t basic_dict<V>::match(Group const &group, uint8_t ctrl) {
+#if defined(MYJSON_SCAN_AVX2) || defined(MYJSON_SCAN_SSE2)
+  __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group.ctrl));
+  return (uint32_t)_mm_movemask_epi8(
+      _mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(ctrl))));
+#else
+  uint32_t bits = 0;
+  for (size_t i = 0; i < group_size; i++)
+    bits |= uint32_t(group.ctrl[i] == ctrl) << i;
+  return bits;
+#endif
+}
+
+/**
+ * 没有索引时从头比较
+ * @return 找不到返回 size()
+ */
+template <class V>
+inline size_t basic_dict<V>::linear_find(std::string_view key) const {
+  value_type *const *order = entries();
+  size_t i = 0;
+  for (; i < m_size; i++)
+    if (order[i]->first == key)
+      break;
+  return i;
+}
+
+/**
+ * 在索引里找：从 hash 的低位决定的那一组开始，一组一组往后找，
+ * 一组里有空位就说明后面也不会有了
+ * @return 找不到返回 size()
+ */
+template <class V>
+inline size_t basic_dict<V>::lookup(hashed_key const &key) const {
+  uint8_t tag = tag_of(key.hash);
+  value_type *const *order = entries();
+  size_t mask = m_groups.size() - 1;
+  for (size_t g = key.hash & mask;; g = (g + 1) & mask) {
+    Group const &group = m_groups[g];
+    for (uint32_t bits = match(group, tag); bits; bits &= bits - 1) {
+      int slot = scan::ctz(bits);
+      if (group.hash[slot] == key.hash &&
+          order[group.index[slot]]->first == key.key)
+        return group.index[slot];
+    }
+    if (match(group, empty_ctrl))
+      return m_size;
+  }
+}
+
+/* 把 entries()[index] 放进索引里 hash 对应的第一个空位 */
+template <class V>
+inline void basic_dict<V>::index_insert(uint32_t index, size_t hash) {
+  size_t mask = m_groups.size() - 1;
+  for (size_t g = hash & mask;; g = (g + 1) & mask) {
+    Group &group = m_groups[g];
+    if (uint32_t bits = match(group, empty_ctrl)) {
+      int slot = scan::ctz(bits);
+      group.ctrl[slot] = tag_of(hash);
+      group.index[slot] = index;
+      group.hash[slot] = hash;
+      return;
+    }
+  }
+}
+
+/**
+ * 按新的组数重建索引，hash 直接用旧索引里缓存的
+ * @param groups 必须是 2 的幂
+ * @param erased 刚刚从 entries() 里删掉的下标，它后面的下标都要减一
+ */
+template <class V>
+inline void basic_dict<V>::rebuild_index(size_t groups, size_t erased) {
+  std::pmr::vector<Group> old(std::move(m_groups));
+  m_groups.clear();
+  m_groups.resize(groups);
+  for (auto &group : old) {
+    for (size_t slot = 0; slot < group_size; slot++) {
+      if (group.ctrl[slot] == empty_ctrl || group.index[slot] == erased)
+        continue;
+      uint32_t index = group.index[slot];
+      index_insert(index > erased ? index - 1 : index, group.hash[slot]);
+    }
+  }
+}
+
+/**
+ * 用字符串构造一个新 key：堆上的 dict 拷贝一份由 key 自己管理，
+ * arena 里的 dict 不会被析构，所以长的 key 也要拷贝进 arena 里再借用
+ */
+template <class V>
+inline DictKey basic_dict<V>::make_key(std::string_view key) const {
+  auto *resource = get_allocator().resource();
+  if (key.size() <= DictKey::inline_size ||
+      resource == std::pmr::get_default_resource())
+    return DictKey(key);
+  char *data = static_cast<char *>(resource->allocate(key.size(), 1));
+  std::memcpy(data, key.data(), key.size());
+  return DictKey::Ref({data, key.size()});
+}
+
+/**
+ * 新开一块能放 capacity 个键值对的内存，以后的键值对都放在这一块里，
+ * 指针数组也搬到这一块的末尾
+ */
+template <class V> inline void basic_dict<V>::add_block(size_t capacity) {
+  size_t order_capacity = (m_block ? m_block->order_capacity : 0) + capacity;
+  if (order_capacity > UINT32_MAX)
+    throw std::length_error("too many keys in dict");
+  auto *resource = get_allocator().resource();
+  auto *block = static_cast<Block *>(resource->allocate(
+      Block::bytes(capacity, order_capacity), Block::align));
+  block->prev = m_block;
+  block->capacity = static_cast<uint32_t>(capacity);
+  block->used = 0;
+  block->order_capacity = static_cast<uint32_t>(order_capacity);
+  if (m_size)
+    std::memcpy(block->order(), m_block->order(), m_size * sizeof(value_type *));
+  m_block = block;
+}
+
+/**
+ * 在末尾构造一个键值对，最后一块满了就新开一块，大小是已有的总和（至少 4 个），
+ * 这样块数是 log(n) 级别的。调用者负责更新索引
+ * @param args 直接传给 value_type 的构造函数
+ */
+template <class V>
+template <class... Args>
+inline void basic_dict<V>::append(Args &&...args) {
+  if (m_block == nullptr || m_block->used == m_block->capacity)
+    add_block(std::max(size_t(m_block ? m_block->order_capacity : 0), size_t(4)));
+  value_type *node = m_block->data() + m_block->used;
+  ::new (static_cast<void *>(node)) value_type(std::forward<Args>(args)...);
+  m_block->used++;
+  m_block->order()[m_size++] = node;
+}
+
+/**
+ * 按顺序拷贝 other 的所有键值对，索引由调用者拷贝。
+ * arena 里的 dict 不会被析构，所以 key 用 make_key 拷贝，
+ * V 支持的话（比如 JObject）值也拷贝进同一个 memory_resource
+ */
+template <class V>
+inline void basic_dict<V>::append_all(basic_dict const &other) {
+  auto *resource = get_allocator().resource();
+  reserve(other.size());
+  for (auto &[key, value] : other) {
+    if constexpr (std::is_constructible_v<V, V const &,
+                                          std::pmr::memory_resource *>) {
+      if (resource != std::pmr::get_default_resource()) {
+        append(std::piecewise_construct, std::forward_as_tuple(make_key(key)),
+               std::forward_as_tuple(value, resource));
+        continue;
+      }
+    }
+    append(std::piecewise_construct, std::forward_as_tuple(make_key(key)),
+           std::forward_as_tuple(value));
+  }
+}
+
+/**
+ * 保证再插入 n - size() 个键值对时不用再分配内存
+ * @param n
+ */
+template <class V> inline void basic_dict<V>::reserve(size_t n) {
+  if (n <= m_size)
+    return;
+  size_t need = n - m_size;
+  if (m_block == nullptr || m_block->capacity - m_block->used < need)
+    add_block(need);
+}
+
+/* 析构所有的键值对，释放它们所在的内存 */
+template <class V> inline void basic_dict<V>::clear() {
+  value_type *const *order = entries();
+  for (size_t i = 0; i < m_size; i++)
+    std::destroy_at(order[i]);
+  auto *resource = get_allocator().resource();
+  while (m_block) {
+    Block *prev = m_block->prev;
+    resource->deallocate(m_block,
+                         Block::bytes(m_block->capacity, m_block->order_capacity),
+                         Block::align);
+    m_block = prev;
+  }
+  m_size = 0;
+  m_groups.clear();
+}
+
+template <class V>
+basic_dict<V> &basic_dict<V>::operator=(basic_dict const &other) {
+  if (this != &other) {
+    clear();
+    append_all(other);
+    m_groups = other.m_groups;
+  }
+  return *this;
+}
+
+/**
+ * allocator 相同时直接把 other 的内存拿过来；
+ * 不同时（比如从 arena 里的 dict 赋值给堆上的）只能拷贝：
+ * 移动过来的值还会指向 other 的内存，而它可能随 arena 一起释放
+ */
+template <class V>
+basic_dict<V> &basic_dict<V>::operator=(basic_dict &&other) {
+  if (this == &other)
+    return *this;
+  clear();
+  if (get_allocator() == other.get_allocator()) {
+    std::swap(m_block, other.m_block);
+    std::swap(m_size, other.m_size);
+    m_groups.swap(other.m_groups);
+    return *this;
+  }
+  append_all(other);
+  m_groups = other.m_groups;
+  other.clear();
+  return *this;
+}
+
+/**
+ * 在末尾插入了一个键值对之后更新索引：
+ * 刚好超过 small_size 时建索引，装填超过 7/8 时组数翻倍
+ * @param hash 新 key 的 hash，还没有索引时不用
+ */
+template <class V> inline void basic_dict<V>::inserted(size_t hash) {
+  size_t n = m_size;
+  if (indexed()) {
+    if (n * 8 > m_groups.size() * group_size * 7)
+      rebuild_index(m_groups.size() * 2);
+    index_insert(static_cast<uint32_t>(n - 1), hash);
+  } else if (n > small_size) {
+    if (n > UINT32_MAX)
+      throw std::length_error("too many keys in dict");
+    size_t groups = 1;
+    while (groups * group_size * 7 < n * 8)
+      groups *= 2;
+    m_groups.resize(groups);
+    for (size_t i = 0; i < n; i++)
+      index_insert(static_cast<uint32_t>(i), hash_of(entries()[i]->first));
+  }
+}
+
+template <class V>
+template <class K, class... Args>
+std::pair<typename basic_dict<V>::iterator, bool>
+basic_dict<V>::try_emplace(hashed_key const &hashed, K &&key,
+                           Args &&...args) {
+  size_t index = index_of(hashed);
+  if (index != m_size)
+    return {begin() + index, false};
+  /*移动进来的 key 直接拿过来；但 arena 里的 dict 不会被析构，
+   *在堆上的 key 要换成 make_key 拷贝进 arena 的那一份*/
+  if constexpr (std::is_same_v<K, DictKey>) {
+    if (!key.on_heap() ||
+        get_allocator().resource() == std::pmr::get_default_resource()) {
+      append(std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+             std::forward_as_tuple(std::forward<Args>(args)...));
+      inserted(hashed.hash);
+      return {end() - 1, true};
+    }
+  }
+  append(std::piecewise_construct, std::forward_as_tuple(make_key(hashed.key)),
+         std::forward_as_tuple(std::forward<Args>(args)...));
+  inserted(hashed.hash);
+  return {end() - 1, true};
+}
+
+/**
+ * @param key
+ * @return 找不到时抛出异常
+ */
+template <class V> V &basic_dict<V>::at(std::string_view key) {
+  size_t index = index_of(key);
+  if (index == m_size)
+    throw std::out_of_range("key not found in dict");
+  return entries()[index]->second;
+}
+
+/**
+ * 删除 key，后面的键值对依次往前移，顺序不变
+ * （移动的只是指针，其余键值对的引用依然有效）
+ * @param key
+ * @return 删除的个数（0 或 1）
+ */
+template <class V> size_t basic_dict<V>::erase(std::string_view key) {
+  size_t index = index_of(key);
+  if (index == m_size)
+    return 0;
+  value_type **order = entries();
+  std::destroy_at(order[index]);
+  std::copy(order + index + 1, order + m_size, order + index);
+  m_size--;
+  if (m_size <= small_size)
+    m_groups.clear();
+  else if (indexed())
+    rebuild_index(m_groups.size(), index);
+  return 1;
+}
+} // namespace json
+
+#endif // MYJSON_PARSER_DICT_H
@@ -0,0 +1,96 @@
+#ifndef MYJSON_PARSER_DOCUMENT_H
+#define MYJSON_PARSER_DOCUMENT_H
+
+#include "Parser.h"
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+
+namespace json {
+/*
+ ======================================================================
+ |                         Document 类定义开始                         |
+ ======================================================================
+ */
+/**
+ * 带 arena 的文档：解析出来的所有节点、字符串、list 和 dict 的内存
+ * 都从 m_arena 里分配，Document 析构（或者 Clear）时一次性释放，
+ * 不会递归地去析构每一个 JObject。
+ *
+ * 注意：树里的节点不知道自己在 arena 里，所以普通的修改
+ * （r["c"] = r["a"]、= std::string(...)、push_back 等）拷贝或者移动进来的
+ * 都是堆上的数据（长字符串、容器），它们不会被释放，也就是泄漏了，
+ * 哪怕值本来就来自同一个文档也一样。修改文档时先用 Copy 把值拷贝进 arena：
+ *   r["c"] = doc.Copy(r["a"]);
+ * 移动赋值只是把 arena 里的指针拿过来，不会再分配。
+ */
+class Document {
+public:
+  Document() = default;
+  /* arena 的地址被树里的每个容器记住了，所以不能拷贝也不能移动 */
+  Document(Document const &) = delete;
+  Document &operator=(Document const &) = delete;
+
+  /* table 不为空时 key 和短的字符串值借用 table 里的（见 Intern.h），不再拷贝进 arena */
+  JObject &Parse(string_view content, InternTable *table = nullptr,
+                 SYNTAX syntax = SYNTAX_STRICT);
+  JObject &Root();
+  JObject Copy(JObject const &value);
+  void Clear();
+
+private:
+  std::pmr::monotonic_buffer_resource m_arena;
+  /* 根节点也放在 arena 里，并且故意不调用它的析构函数 */
+  JObject *m_root{nullptr};
+};
+/*
+ ======================================================================
+ |                         Document 类定义结束                         |
+ ======================================================================
+ */
+
+/**
+ * 解析 content，旧的内容会先被丢弃
+ * @param content
+ * @param table 必须比 Document 活得久
+ * @param syntax
+ * @return 根节点，生命周期和 Document 一样
+ */
+inline JObject &Document::Parse(string_view content, InternTable *table,
+                                SYNTAX syntax) {
+  Clear();
+  Parser parser;
+  parser.init(content, false, &m_arena, table);
+  parser.set_syntax(syntax);
+  JObject root = parser.parse();
+  void *mem = m_arena.allocate(sizeof(JObject), alignof(JObject));
+  m_root = new (mem) JObject(std::move(root));
+  return *m_root;
+}
+
+inline JObject &Document::Root() {
+  if (m_root == nullptr)
+    throw std::logic_error("empty document! Document::Root()");
+  return *m_root;
+}
+
+/**
+ * 把 value 深拷贝进这个文档的 arena，用来修改文档：
+ * 结果赋值或者插入到这个文档的树里时不会泄漏
+ * @param value 可以来自任何地方，包括这个文档自己
+ * @return 数据都在 arena 里，Clear 之后就不能再用了
+ */
+inline JObject Document::Copy(JObject const &value) {
+  return JObject(value, &m_arena);
+}
+
+/**
+ * 一次性释放整个文档，不调用任何 JObject 的析构函数
+ */
+inline void Document::Clear() {
+  m_root = nullptr;
+  m_arena.release();
+}
+} // namespace json
+
+#endif // MYJSON_PARSER_DOCUMENT_H
@@ -0,0 +1,344 @@
+#ifndef MYJSON_PARSER_DOCUMENTCACHE_H
+#define MYJSON_PARSER_DOCUMENTCACHE_H
+
+#include "MappedFile.h"
+#include "Parser.h"
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+
+namespace json {
+/*
+ ======================================================================
+ |                     DocumentCache 类定义开始                         |
+ ======================================================================
+ */
+/**
+ * 解析结果的缓存：同样内容的 JSON 只解析一次，之后只需要算一次 hash、查一次表。
+ * 按内容的 hash 查找，命中时还会比较一遍内容，hash 冲突不会返回错误的结果；
+ * FromFile 按路径、设备号、inode、大小和修改时间判断文件有没有变，没变的话连文件都不用读。
+ * 返回的是共享的、不可修改的 JObject，要修改的话自己拷贝一份。
+ * 缓存里保存一份输入，字符串值直接借用它（和 FromStringView 一样），
+ * 所以多存一份输入基本不会多占内存。
+ * 总的内存（估算）超过 max_bytes 时淘汰最久没有用过的；被淘汰的文档
+ * 只是不在缓存里了，外面拿着的 shared_ptr 依然有效。
+ * 所有的方法都是线程安全的，解析在锁外面进行。
+ * 一个缓存里的文档都按构造时的 syntax 解析（Global() 是严格的）。
+ */
+class DocumentCache {
+public:
+  struct Stats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0; /* 当前缓存了几个文档 */
+    size_t bytes = 0;   /* 当前占用的内存（估算） */
+  };
+
+  explicit DocumentCache(size_t max_bytes = size_t(64) << 20,
+                         SYNTAX syntax = SYNTAX_STRICT)
+      : m_max_bytes(max_bytes), m_syntax(syntax) {}
+  DocumentCache(DocumentCache const &) = delete;
+  DocumentCache &operator=(DocumentCache const &) = delete;
+  /* 整个进程共用的缓存 */
+  static DocumentCache &Global() {
+    static DocumentCache cache;
+    return cache;
+  }
+
+  std::shared_ptr<const JObject> FromString(string_view content);
+  std::shared_ptr<const JObject> FromFile(std::string const &path);
+  Stats Counters() const;
+  /* 修改内存上限，超出的马上淘汰 */
+  void SetMaxBytes(size_t max_bytes);
+  /* 清空缓存和计数 */
+  void Clear();
+
+private:
+  struct Entry {
+    size_t hash;
+    std::string text;
+    JObject root; /* 字符串值借用 text */
+    size_t bytes;
+  };
+  using EntryPtr = std::shared_ptr<Entry>;
+  using LruList = std::list<EntryPtr>;
+  /* 文件的设备号、inode、大小和修改时间，以及上次读出来的文档 */
+  struct FileKey {
+    uint64_t dev;
+    uint64_t ino;
+    uintmax_t size;
+    std::filesystem::file_time_type mtime;
+    std::weak_ptr<Entry> entry;
+
+    bool same_file(FileKey const &other) const {
+      return dev == other.dev && ino == other.ino && size == other.size &&
+             mtime == other.mtime;
+    }
+  };
+
+  static std::shared_ptr<const JObject> root_of(EntryPtr const &entry) {
+    return {entry, &entry->root};
+  }
+  static size_t footprint(JObject const &value, string_view text);
+  static FileKey stat_file(std::string const &path);
+  EntryPtr load(string_view content);
+  EntryPtr find(size_t hash, string_view content);
+  void touch(Entry const &entry);
+  void insert(EntryPtr entry);
+  void evict();
+  void prune_files();
+
+  mutable std::mutex m_mutex;
+  size_t m_max_bytes;
+  SYNTAX m_syntax;
+  LruList m_lru; /* 最近用过的在前面 */
+  std::unordered_map<size_t, LruList::iterator> m_index;
+  std::unordered_map<std::string, FileKey> m_files;
+  Stats m_stats;
+};
+/*
+ ======================================================================
+ |                     DocumentCache 类定义结束                         |
+ ======================================================================
+ */
+
+/**
+ * 在缓存里找 content，找到的话移到 LRU 的最前面。调用时要持有锁
+ * @return 找不到（或者只是 hash 相同）返回空
+ */
+inline DocumentCache::EntryPtr DocumentCache::find(size_t hash,
+                                                   string_view content) {
+  auto it = m_index.find(hash);
+  if (it == m_index.end() || (*it->second)->text != content)
+    return nullptr;
+  m_lru.splice(m_lru.begin(), m_lru, it->second);
+  return *it->second;
+}
+
+/* entry 还在缓存里的话移到 LRU 的最前面。调用时要持有锁 */
+inline void DocumentCache::touch(Entry const &entry) {
+  auto it = m_index.find(entry.hash);
+  if (it != m_index.end() && it->second->get() == &entry)
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+}
+
+/* 放进缓存，hash 相同的旧文档被替换。调用时要持有锁 */
+inline void DocumentCache::insert(EntryPtr entry) {
+  auto it = m_index.find(entry->hash);
+  if (it != m_index.end()) {
+    m_stats.bytes -= (*it->second)->bytes;
+    m_lru.erase(it->second);
+    m_index.erase(it);
+  }
+  m_stats.bytes += entry->bytes;
+  m_lru.push_front(entry);
+  m_index.emplace(entry->hash, m_lru.begin());
+  evict();
+}
+
+/* 超出内存上限时从后往前淘汰，刚放进来的那一个总是留着。调用时要持有锁 */
+inline void DocumentCache::evict() {
+  bool evicted = false;
+  while (m_stats.bytes > m_max_bytes && m_lru.size() > 1) {
+    EntryPtr &last = m_lru.back();
+    m_stats.bytes -= last->bytes;
+    m_index.erase(last->hash);
+    m_lru.pop_back();
+    m_stats.evictions++;
+    evicted = true;
+  }
+  m_stats.entries = m_lru.size();
+  if (evicted)
+    prune_files();
+}
+
+/* 删掉文档已经释放了的文件记录，不然读过的路径会一直留在 m_files 里。调用时要持有锁 */
+inline void DocumentCache::prune_files() {
+  for (auto it = m_files.begin(); it != m_files.end();) {
+    if (it->second.entry.expired())
+      it = m_files.erase(it);
+    else
+      ++it;
+  }
+}
+
+/**
+ * 估算解析结果占用的内存：节点、容器的空间，以及没有借用 text 的字符串
+ * @param value
+ * @param text 借用的输入
+ * @return
+ */
+inline size_t DocumentCache::footprint(JObject const &value,
+                                       string_view text) {
+  size_t bytes = 0;
+  switch (value.Type()) {
+  case T_STR: {
+    str_view_t str = value.Value<str_view_t>();
+    bool borrowed = str.data() >= text.data() &&
+                    str.data() + str.size() <= text.data() + text.size();
+    if (!borrowed && str.size() > JObject::inline_size)
+      bytes += str.size();
+    break;
+  }
+  case T_LIST: {
+    auto &list = value.Value<list_t>();
+    bytes += sizeof(list_t) + list.capacity() * sizeof(JObject);
+    for (auto &item : list)
+      bytes += footprint(item, text);
+    break;
+  }
+  case T_DICT: {
+    auto &dict = value.Value<dict_t>();
+    /*每个键值对和指向它的指针，加上 key 多时的 hash 索引（每个槽位大约 16 字节）*/
+    bytes += sizeof(dict_t) +
+             dict.size() * (sizeof(dict_t::value_type) + sizeof(void *) + 16);
+    for (auto &[key, item] : dict) {
+      if (key.size() > DictKey::inline_size)
+        bytes += key.size();
+      bytes += footprint(item, text);
+    }
+    break;
+  }
+  default:
+    break;
+  }
+  return bytes;
+}
+
+/**
+ * 解析 content，同样的内容之前解析过的话直接返回缓存的结果
+ * @param content
+ * @return 不可修改的共享结果，解析失败时抛出异常，不会缓存
+ */
+inline std::shared_ptr<const JObject>
+DocumentCache::FromString(string_view content) {
+  return root_of(load(content));
+}
+
+/* 查找或者解析 content，FromString 和 FromFile 共用 */
+inline DocumentCache::EntryPtr DocumentCache::load(string_view content) {
+  size_t hash = std::hash<string_view>{}(content);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (EntryPtr entry = find(hash, content)) {
+      m_stats.hits++;
+      return entry;
+    }
+    m_stats.misses++;
+  }
+  /*解析在锁外面进行，不同的文档可以同时解析*/
+  auto entry = std::make_shared<Entry>();
+  entry->hash = hash;
+  entry->text.assign(content);
+  entry->root = Parser::FromStringView(entry->text, m_syntax);
+  entry->bytes =
+      sizeof(Entry) + entry->text.size() + footprint(entry->root, entry->text);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  /*别的线程可能已经解析好放进来了，用先放进来的那一份*/
+  if (EntryPtr cached = find(hash, content))
+    return cached;
+  insert(entry);
+  return entry;
+}
+
+/**
+ * 取文件的设备号、inode、大小和修改时间。
+ * 只比较大小和修改时间的话，同一秒里被换成另一个同样大小的文件（比如 rename 覆盖）
+ * 在修改时间精度低的文件系统上会认不出来
+ * @param path
+ * @return
+ */
+inline DocumentCache::FileKey DocumentCache::stat_file(std::string const &path) {
+  std::error_code error;
+  FileKey key{};
+  key.size = std::filesystem::file_size(path, error);
+  if (!error)
+    key.mtime = std::filesystem::last_write_time(path, error);
+  if (error)
+    throw std::logic_error("can not open file in DocumentCache::FromFile");
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(path.c_str(), 0,
+                            FILE_SHARE_READ | FILE_SHARE_WRITE |
+                                FILE_SHARE_DELETE,
+                            nullptr, OPEN_EXISTING, 0, nullptr);
+  BY_HANDLE_FILE_INFORMATION info;
+  bool ok = file != INVALID_HANDLE_VALUE &&
+            GetFileInformationByHandle(file, &info);
+  if (file != INVALID_HANDLE_VALUE)
+    CloseHandle(file);
+  if (!ok)
+    throw std::logic_error("can not open file in DocumentCache::FromFile");
+  key.dev = info.dwVolumeSerialNumber;
+  key.ino = (uint64_t(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+#else
+  struct stat st;
+  if (::stat(path.c_str(), &st) != 0)
+    throw std::logic_error("can not open file in DocumentCache::FromFile");
+  key.dev = uint64_t(st.st_dev);
+  key.ino = uint64_t(st.st_ino);
+#endif
+  return key;
+}
+
+/**
+ * 解析文件：设备号、inode、大小和修改时间都没变时直接返回上次的结果，不读文件
+ * （已经被淘汰、但是外面还有人拿着的也可以）；
+ * 变了的话重新读，内容其实没变的话还是会命中 FromString 的缓存
+ * @param path
+ * @return
+ */
+inline std::shared_ptr<const JObject>
+DocumentCache::FromFile(std::string const &path) {
+  FileKey key = stat_file(path);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_files.find(path);
+    if (it != m_files.end()) {
+      EntryPtr entry = it->second.entry.lock();
+      if (entry && it->second.same_file(key)) {
+        touch(*entry);
+        m_stats.hits++;
+        return root_of(entry);
+      }
+      if (!entry) /*文档已经释放了，记录也没用了*/
+        m_files.erase(it);
+    }
+  }
+  /*先 stat 再读：读的时候文件又变了的话，下次 stat 出来的修改时间也会不一样*/
+  EntryPtr entry = load(MappedFile(path).view());
+  key.entry = entry;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_files[path] = key;
+  return root_of(entry);
+}
+
+inline DocumentCache::Stats DocumentCache::Counters() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+inline void DocumentCache::SetMaxBytes(size_t max_bytes) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_max_bytes = max_bytes;
+  evict();
+}
+
+inline void DocumentCache::Clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_lru.clear();
+  m_index.clear();
+  m_files.clear();
+  m_stats = Stats();
+}
+} // namespace json
+
+#endif // MYJSON_PARSER_DOCUMENTCACHE_H
@@ -0,0 +1,213 @@
+#ifndef MYJSON_PARSER_ESCAPE_H
+#define MYJSON_PARSER_ESCAPE_H
+
+#include "Scanner.h"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+namespace json {
+namespace esc {
+/*
+ * 字符串的转义和反转义。
+ * 绝大多数字符串里根本没有要处理的字符，所以两边都是先用 SIMD 一次检查
+ * 16/32 个字节，找到下一个要处理的字符，中间的一整段直接整块拷贝。
+ */
+
+/* 需要转义的字符：" \ 和 0x00~0x1F 的控制字符 */
+inline bool need_escape(char ch) {
+  return ch == '"' || ch == '\\' || (unsigned char)ch < 0x20;
+}
+
+/**
+ * [p, end) 中第一个 \ 的位置
+ * @return 没有返回 end
+ */
+inline const char *find_backslash(const char *p, const char *end) {
+#if defined(MYJSON_SCAN_AVX2)
+  for (; end - p >= 32; p += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    if (uint32_t bits = scan::eq32(v, '\\'))
+      return p + scan::ctz(bits);
+  }
+#elif defined(MYJSON_SCAN_SSE2)
+  for (; end - p >= 16; p += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    if (uint64_t bits = scan::eq16(v, '\\'))
+      return p + scan::ctz(bits);
+  }
+#endif
+  while (p != end && *p != '\\')
+    p++;
+  return p;
+}
+
+/**
+ * [p, end) 中第一个需要转义的字符的位置
+ * @return 没有返回 end
+ */
+inline const char *find_escape(const char *p, const char *end) {
+#if defined(MYJSON_SCAN_AVX2)
+  const __m256i ctrl = _mm256_set1_epi8(0x1F);
+  for (; end - p >= 32; p += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    /* 无符号的 max(v, 0x1F) == 0x1F 就是 v <= 0x1F */
+    uint32_t bits = scan::eq32(v, '"') | scan::eq32(v, '\\') |
+                    (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                        _mm256_max_epu8(v, ctrl), ctrl));
+    if (bits)
+      return p + scan::ctz(bits);
+  }
+#elif defined(MYJSON_SCAN_SSE2)
+  const __m128i ctrl = _mm_set1_epi8(0x1F);
+  for (; end - p >= 16; p += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    uint64_t bits =
+        scan::eq16(v, '"') | scan::eq16(v, '\\') |
+        (uint16_t)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_max_epu8(v, ctrl), ctrl));
+    if (bits)
+      return p + scan::ctz(bits);
+  }
+#endif
+  while (p != end && !need_escape(*p))
+    p++;
+  return p;
+}
+
+/* \u 后面的 4 个十六进制数字 */
+inline uint32_t parse_hex4(const char *p, const char *end) {
+  if (end - p < 4)
+    throw std::logic_error("invalid unicode escape in parse string");
+  uint32_t cp = 0;
+  for (int i = 0; i < 4; i++) {
+    char ch = p[i];
+    cp <<= 4;
+    if (ch >= '0' && ch <= '9')
+      cp |= ch - '0';
+    else if (ch >= 'a' && ch <= 'f')
+      cp |= ch - 'a' + 10;
+    else if (ch >= 'A' && ch <= 'F')
+      cp |= ch - 'A' + 10;
+    else
+      throw std::logic_error("invalid unicode escape in parse string");
+  }
+  return cp;
+}
+
+/* 把码点写成 UTF-8，返回写完之后的位置 */
+inline char *encode_utf8(uint32_t cp, char *out) {
+  if (cp < 0x80) {
+    *out++ = char(cp);
+  } else if (cp < 0x800) {
+    *out++ = char(0xC0 | (cp >> 6));
+    *out++ = char(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    *out++ = char(0xE0 | (cp >> 12));
+    *out++ = char(0x80 | ((cp >> 6) & 0x3F));
+    *out++ = char(0x80 | (cp & 0x3F));
+  } else {
+    *out++ = char(0xF0 | (cp >> 18));
+    *out++ = char(0x80 | ((cp >> 12) & 0x3F));
+    *out++ = char(0x80 | ((cp >> 6) & 0x3F));
+    *out++ = char(0x80 | (cp & 0x3F));
+  }
+  return out;
+}
+
+/**
+ * 反转义：把 "..." 中间的原始内容解码成真正的字符串，
+ * \uXXXX 转成 UTF-8，代理对（😀）合成一个码点。
+ * 解码之后不会变长，所以 out 有 raw.size() 个字节就够了。
+ * @param raw 引号中间的原始内容
+ * @param out 输出缓冲区
+ * @return 解码之后的长度
+ */
+inline size_t unescape(std::string_view raw, char *out) {
+  const char *p = raw.data(), *end = p + raw.size();
+  char *o = out;
+  while (true) {
+    /* 两个 \ 之间的一段原样整块拷贝 */
+    const char *bs = find_backslash(p, end);
+    if (bs != p) {
+      std::memcpy(o, p, bs - p);
+      o += bs - p;
+    }
+    if (bs == end)
+      break;
+    p = bs + 1;
+    if (p == end)
+      throw std::logic_error("invalid escape in parse string");
+    switch (*p++) {
+    case '"': *o++ = '"'; break;
+    case '\\': *o++ = '\\'; break;
+    case '/': *o++ = '/'; break;
+    case 'b': *o++ = '\b'; break;
+    case 'f': *o++ = '\f'; break;
+    case 'n': *o++ = '\n'; break;
+    case 'r': *o++ = '\r'; break;
+    case 't': *o++ = '\t'; break;
+    case 'u': {
+      uint32_t cp = parse_hex4(p, end);
+      p += 4;
+      if (cp >= 0xD800 && cp <= 0xDBFF) { /* 高代理，后面必须跟一个低代理 */
+        if (end - p < 6 || p[0] != '\\' || p[1] != 'u')
+          throw std::logic_error("unpaired surrogate in parse string");
+        uint32_t low = parse_hex4(p + 2, end);
+        if (low < 0xDC00 || low > 0xDFFF)
+          throw std::logic_error("unpaired surrogate in parse string");
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+        p += 6;
+      } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+        throw std::logic_error("unpaired surrogate in parse string");
+      }
+      o = encode_utf8(cp, o);
+      break;
+    }
+    default:
+      throw std::logic_error("invalid escape in parse string");
+    }
+  }
+  return o - out;
+}
+
+/**
+ * 转义：把字符串写成 JSON 的 "..."，两边的引号也会写进去。
+ * " \ 和常见的控制字符用短的形式，其余控制字符用 \u00XX，其他字节（包括 UTF-8）原样输出。
+ * @tparam Sink 需要有 append(const char *, size_t) 和 push_back(char)
+ * @param str
+ * @param out
+ */
+template <class Sink> void escape(std::string_view str, Sink &out) {
+  static constexpr char hex[] = "0123456789abcdef";
+  const char *p = str.data(), *end = p + str.size();
+  out.push_back('"');
+  while (true) {
+    const char *q = find_escape(p, end);
+    if (q != p)
+      out.append(p, q - p);
+    if (q == end)
+      break;
+    char ch = *q;
+    switch (ch) {
+    case '"': out.append("\\\"", 2); break;
+    case '\\': out.append("\\\\", 2); break;
+    case '\b': out.append("\\b", 2); break;
+    case '\f': out.append("\\f", 2); break;
+    case '\n': out.append("\\n", 2); break;
+    case '\r': out.append("\\r", 2); break;
+    case '\t': out.append("\\t", 2); break;
+    default: {
+      char buf[6] = {'\\', 'u', '0', '0', hex[(ch >> 4) & 0xF], hex[ch & 0xF]};
+      out.append(buf, 6);
+    }
+    }
+    p = q + 1;
+  }
+  out.push_back('"');
+}
+} // namespace esc
+} // namespace json
+
+#endif // MYJSON_PARSER_ESCAPE_H
@@ -0,0 +1,278 @@
+#ifndef MYJSON_PARSER_HANDLER_H
+#define MYJSON_PARSER_HANDLER_H
+
+#include "Intern.h"
+#include "JObject.h"
+#include "Stats.h"
+#include <cstring>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace json {
+/*
+ ======================================================================
+ |                       事件接口（SAX）定义开始                        |
+ ======================================================================
+ */
+/**
+ * Parser 每解析出一个 token 就调用 Handler 的一个方法：
+ *   null() boolean() integer() number() str()   标量
+ *   key()                                       dict 的 key
+ *   start_object() end_object()                 { }
+ *   start_array()  end_array()                  [ ]
+ * 传进来的 string_view 只保证在这次调用期间有效，要保存的话自己拷贝。
+ * 继承 BaseHandler 之后只需要写关心的方法，其余的什么都不做。
+ */
+struct BaseHandler {
+  void null() {}
+  void boolean(bool_t) {}
+  void integer(int_t) {}
+  void number(double_t) {}
+  void str(string_view) {}
+  void key(string_view) {}
+  void start_object() {}
+  void end_object() {}
+  void start_array() {}
+  void end_array() {}
+};
+
+/*
+ ======================================================================
+ |                       DomBuilder 类定义开始                          |
+ ======================================================================
+ */
+/**
+ * 用事件构建 JObject 树的 Handler，Parser::parse() 就是用它实现的。
+ * 只保存从根到当前节点的一条路径，以及这条路径上还没有结束的 dict 已经解析出来的键值对。
+ * dict 的键值对先放在 m_members 里，到 } 时才知道一共有几个，
+ * 一次分配好 dict 的空间再把 key 和 value 都移动进去，
+ * 不会一边插入一边扩容（在 arena 里扩容时旧的空间是不会回收的）。
+ */
+class DomBuilder : public BaseHandler {
+public:
+  /**
+   * @param arena 不为空时所有的容器、key、字符串都从这里分配（见 Document）
+   * @param source 零拷贝模式下的输入：落在它里面的字符串直接借用，
+   *               不在里面的（比如解码过转义的）还是要拷贝
+   * @param intern 不为空时所有的 key 和不超过 MaxValueLength() 的字符串值
+   *               都借用表里的那一份（见 Intern.h）
+   */
+  explicit DomBuilder(std::pmr::memory_resource *arena = nullptr,
+                      string_view source = {}, InternTable *intern = nullptr)
+      : m_arena(arena), m_source(source), m_intern(intern) {}
+
+  void null() { add(JObject(), m_key); }
+  void boolean(bool_t value) { add(value, m_key); }
+  void integer(int_t value) { add(value, m_key); }
+  void number(double_t value) { add(value, m_key); }
+  void str(string_view value);
+  /* key 马上放进 m_key（intern 表、arena 或者 key 自己），插入时直接移动进去 */
+  void key(string_view key);
+  void start_object() {
+    m_stack.push_back(
+        {JObject(T_DICT, m_arena), std::move(m_key), m_members.size()});
+  }
+  void start_array() {
+    m_stack.push_back({JObject(T_LIST, m_arena), std::move(m_key), 0});
+  }
+  void end_object() { end_container(); }
+  void end_array() { end_container(); }
+
+  /* 解析结束之后拿到整棵树 */
+  JObject &result() { return m_root; }
+  /* 不为空时把分配的字符串和容器记到 stats 里（见 Stats.h） */
+  void set_stats(Stats *stats) { m_stats = stats; }
+
+private:
+  /* 还没有结束的 list/dict，以及它在父节点里的 key */
+  struct Frame {
+    JObject value;
+    dict_key_t key;
+    size_t first; /* dict 的第一个键值对在 m_members 里的位置 */
+  };
+  string_view copy_to_arena(string_view str);
+  void add(JObject value, dict_key_t &key);
+  void end_container();
+  void count_string(size_t size) {
+    if (m_stats) [[unlikely]] {
+      m_stats->strings++;
+      m_stats->bytes_allocated += size;
+    }
+  }
+
+  std::pmr::memory_resource *m_arena;
+  string_view m_source;
+  InternTable *m_intern;
+  dict_key_t m_key; /* 最近一次的 key */
+  std::vector<Frame> m_stack;
+  std::vector<std::pair<dict_key_t, JObject>> m_members;
+  JObject m_root;
+  Stats *m_stats{nullptr};
+};
+/*
+ ======================================================================
+ |                       DomBuilder 类定义结束                          |
+ ======================================================================
+ */
+
+inline void DomBuilder::key(string_view key) {
+  if (m_intern) {
+    m_key = DictKey::Ref(m_intern->Intern(key));
+    return;
+  }
+  if (key.size() > DictKey::inline_size)
+    count_string(key.size());
+  if (m_arena && key.size() > DictKey::inline_size)
+    m_key = DictKey::Ref(copy_to_arena(key));
+  else /*短的 key 直接放在 DictKey 里，长的在堆上*/
+    m_key = DictKey(key);
+}
+
+/* 拷贝进 arena，随文档一起释放 */
+inline string_view DomBuilder::copy_to_arena(string_view str) {
+  char *data = nullptr;
+  if (!str.empty()) {
+    data = static_cast<char *>(m_arena->allocate(str.size(), 1));
+    std::memcpy(data, str.data(), str.size());
+  }
+  return {data, str.size()};
+}
+
+inline void DomBuilder::str(string_view value) {
+  JObject str;
+  if (!m_source.empty() && value.data() >= m_source.data() &&
+      value.data() + value.size() <= m_source.data() + m_source.size()) {
+    /*零拷贝模式下只记录视图，不拷贝*/
+    str.StrRef(value);
+  } else if (value.size() <= JObject::inline_size) { /*短的直接放在节点里*/
+    str.Str(value);
+  } else if (m_intern && value.size() <= m_intern->MaxValueLength()) {
+    str.StrRef(m_intern->Intern(value));
+  } else if (m_arena) { /*拷贝进 arena，随文档一起释放*/
+    count_string(value.size());
+    str.StrRef(copy_to_arena(value));
+  } else {
+    count_string(value.size());
+    str.Str(value);
+  }
+  add(std::move(str), m_key);
+}
+
+/**
+ * 把一个完整的值挂到当前的 list/dict 上，没有父节点的就是根
+ * @param value
+ * @param key 父节点是 dict 时用的 key
+ */
+inline void DomBuilder::add(JObject value, dict_key_t &key) {
+  if (m_stack.empty()) {
+    m_root = std::move(value);
+    return;
+  }
+  JObject &parent = m_stack.back().value;
+  if (parent.Type() == T_LIST)
+    parent.Value<list_t>().push_back(std::move(value));
+  else /*dict 到 end_container 时再一起插入*/
+    m_members.emplace_back(std::move(key), std::move(value));
+}
+
+inline void DomBuilder::end_container() {
+  Frame frame = std::move(m_stack.back());
+  m_stack.pop_back();
+  if (m_stats) [[unlikely]] { /*容器本身和元素的空间，dict 大了还有索引*/
+    if (frame.value.Type() == T_LIST)
+      m_stats->bytes_allocated +=
+          sizeof(list_t) +
+          frame.value.Value<list_t>().capacity() * sizeof(JObject);
+    else {
+      size_t n = m_members.size() - frame.first;
+      m_stats->bytes_allocated +=
+          sizeof(dict_t) + n * (sizeof(dict_t::value_type) + sizeof(void *)) +
+          (n > dict_t::small_size ? n * 16 : 0);
+    }
+  }
+  if (frame.value.Type() == T_DICT) {
+    auto &dict = frame.value.Value<dict_t>();
+    dict.reserve(m_members.size() - frame.first);
+    /*key 直接移动进去；重复的 key 以后出现的为准，位置还是第一次出现的位置*/
+    for (size_t i = frame.first; i < m_members.size(); i++)
+      dict.insert_or_assign(std::move(m_members[i].first),
+                            std::move(m_members[i].second));
+    m_members.resize(frame.first);
+  }
+  add(std::move(frame.value), frame.key);
+}
+
+/*
+ ======================================================================
+ |                      StatsHandler 类定义开始                         |
+ ======================================================================
+ */
+/**
+ * 打开统计（见 Stats.h）时 Parser 用它包住真正的 Handler：
+ * 按类型数一数节点、记下最深的层数，然后把事件原样转发出去
+ * @tparam Handler 真正接收事件的 Handler（比如 DomBuilder）
+ */
+template <class Handler> class StatsHandler {
+public:
+  StatsHandler(Handler &handler, Stats &stats)
+      : m_handler(handler), m_stats(stats) {}
+
+  void null() {
+    m_stats.nodes[T_NULL]++;
+    m_handler.null();
+  }
+  void boolean(bool_t value) {
+    m_stats.nodes[T_BOOL]++;
+    m_handler.boolean(value);
+  }
+  void integer(int_t value) {
+    m_stats.nodes[T_INT]++;
+    m_handler.integer(value);
+  }
+  void number(double_t value) {
+    m_stats.nodes[T_DOUBLE]++;
+    m_handler.number(value);
+  }
+  void str(string_view value) {
+    m_stats.nodes[T_STR]++;
+    m_handler.str(value);
+  }
+  void key(string_view key) { m_handler.key(key); }
+  void start_object() {
+    m_stats.nodes[T_DICT]++;
+    enter();
+    m_handler.start_object();
+  }
+  void end_object() {
+    m_depth--;
+    m_handler.end_object();
+  }
+  void start_array() {
+    m_stats.nodes[T_LIST]++;
+    enter();
+    m_handler.start_array();
+  }
+  void end_array() {
+    m_depth--;
+    m_handler.end_array();
+  }
+
+private:
+  void enter() {
+    if (++m_depth > m_stats.max_depth)
+      m_stats.max_depth = m_depth;
+  }
+
+  Handler &m_handler;
+  Stats &m_stats;
+  size_t m_depth = 0;
+};
+/*
+ ======================================================================
+ |                      StatsHandler 类定义结束                         |
+ ======================================================================
+ */
+} // namespace json
+
+#endif // MYJSON_PARSER_HANDLER_H
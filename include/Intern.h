@@ -0,0 +1,83 @@
+#ifndef MYJSON_PARSER_INTERN_H
+#define MYJSON_PARSER_INTERN_H
+
+#include "Dict.h"
+#include <cstring>
+#include <memory_resource>
+#include <string_view>
+
+namespace json {
+/*
+ ======================================================================
+ |                       InternTable 类定义开始                         |
+ ======================================================================
+ */
+/**
+ * 字符串的 intern 表：同样内容的字符串只保存一份。
+ * 解析时交给 Parser（或者 DomBuilder），所有的 key，以及不超过 max_value_len 的字符串值
+ * （不超过 JObject::inline_size 的值直接放在节点里，不进表）
+ * 都借用表里的那一份，不再每出现一次就分配一次；
+ * 同一个 key 在所有 dict 里的指针都相同，比较时指针相同就不用再比较内容。
+ * 表可以一直留着解析后面的文档（比如同一种格式的一条条消息），见过的 key 不会再占内存。
+ * 表里的字符串到 Clear() 或者析构时才释放，所以表必须比用它解析出来的 JObject 活得久
+ * （拷贝出来的 JObject 拥有自己的数据，不受影响）。不是线程安全的。
+ */
+class InternTable {
+public:
+  /**
+   * @param max_value_len 不超过这个长度的字符串值也 intern，0 表示只 intern key。
+   * 值大多各不相同的话表会一直变大，所以只适合短的、重复很多的值（比如类型、状态）
+   */
+  explicit InternTable(size_t max_value_len = 0)
+      : m_max_value_len(max_value_len) {}
+  InternTable(InternTable const &) = delete;
+  InternTable &operator=(InternTable const &) = delete;
+
+  std::string_view Intern(std::string_view str);
+  size_t MaxValueLength() const { return m_max_value_len; }
+  /* 表里有多少个不同的字符串，一共多少字节 */
+  size_t Size() const { return m_set.size(); }
+  size_t Bytes() const { return m_bytes; }
+  /* 释放所有的字符串，之前用这个表解析出来的 JObject 都不能再用了 */
+  void Clear() {
+    m_set.clear();
+    m_storage.release();
+    m_bytes = 0;
+  }
+
+private:
+  std::pmr::monotonic_buffer_resource m_storage;
+  basic_dict<bool> m_set; /* key 借用 m_storage 里的字符串，值没有用 */
+  size_t m_bytes{0};
+  size_t m_max_value_len;
+};
+/*
+ ======================================================================
+ |                       InternTable 类定义结束                         |
+ ======================================================================
+ */
+
+/**
+ * 查找 str，没有的话拷贝一份放进表里
+ * @param str
+ * @return 表里的那一份，直到 Clear() 之前都有效
+ */
+inline std::string_view InternTable::Intern(std::string_view str) {
+  hashed_key key(str);
+  auto it = m_set.find(key);
+  if (it != m_set.end())
+    return it->first;
+  char *data = nullptr;
+  if (!str.empty()) {
+    data = static_cast<char *>(m_storage.allocate(str.size(), 1));
+    std::memcpy(data, str.data(), str.size());
+  }
+  /*hash 刚才 find 的时候已经算过了*/
+  m_set.try_emplace(hashed_key({data, str.size()}, key.hash),
+                    DictKey::Ref({data, str.size()}), true);
+  m_bytes += str.size();
+  return {data, str.size()};
+}
+} // namespace json
+
+#endif // MYJSON_PARSER_INTERN_H
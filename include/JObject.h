@@ -1,42 +1,58 @@
 #ifndef MYJSON_PARSER_JOBJECT_H
 #define MYJSON_PARSER_JOBJECT_H
 
+#include "Dict.h"
+#include "Escape.h"
+#include "Number.h"
+#include "Stats.h"
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <map>
+#include <memory_resource>
+#include <new>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <type_traits>
 #include <utility>
-#include <variant>
 #include <vector>
 
 namespace json {
 /* 定义这些是为了方便使用标准库 */
 
-using std::get_if; /*get_if 是 std::variant的一个函数*/
 using std::map;
 using std::string;
 using std::string_view;
 using std::stringstream;
-using std::variant;
 using std::vector;
 
 /* === 枚举类型，用来标记json的数据类型 === */
 enum TYPE { T_NULL, T_BOOL, T_INT, T_DOUBLE, T_STR, T_LIST, T_DICT };
+/* === 解析时接受的语法 ===
+ * // 注释总是可以跳过；list/dict 末尾多一个逗号（比如 [1, 2, ]，
+ * vscode 的配置文件 JSONC 里很常见）只有 SYNTAX_JSONC 才接受，默认是严格的 */
+enum SYNTAX { SYNTAX_STRICT, SYNTAX_JSONC };
 
 class JObject;
 /* json的数据类型 <==> C++的数据类型 */
 using null_t = string;
-using int_t = int32_t;
+using int_t = int64_t; /*支持 64 位整数*/
 using bool_t = bool;
 using double_t = double;
 using str_t = string;
-/* 因为list是可以嵌套的，所以这里用一个 JObject的vector来实现嵌套的效果 */
-using list_t = vector<JObject>;
-/* json的字典其实就是一个C++的map，
- * 或者是 FIXME: unordered_map 相比 map 也许性能会提高*/
-using dict_t = std::unordered_map<string, JObject>;
+/* 零拷贝解析时的字符串：只是指向源缓冲区的视图，不拥有内存 */
+using str_view_t = string_view;
+/* 因为list是可以嵌套的，所以这里用一个 JObject的vector来实现嵌套的效果。
+ * 容器都用 pmr 版本：默认从堆上分配，解析到 Document 时则从它的 arena
+ * 里分配，整个文档最后一次性释放 */
+using list_t = std::pmr::vector<JObject>;
+/* json的字典：保持插入顺序，小的时候是连续的数组，大了再加 hash 索引（见 Dict.h），
+ * key 是 dict_key_t（pmr::string），可以直接用 string_view 查找 */
+using dict_t = basic_dict<JObject>;
 /* 用于在 __编译时__确定两个变量的类型，使用 is_same
  * 模板类，它返回bool值表示两个类型是否相同 */
 
@@ -53,7 +69,7 @@ using dict_t = std::unordered_map<string, JObject>;
 #define IS_TYPE(typeA, typeB) std::is_same<typeA, typeB>::value
 template <class T> constexpr bool is_basic_type() {
   if constexpr (IS_TYPE(T, str_t) || IS_TYPE(T, bool_t) ||
-                IS_TYPE(T, double_t) || IS_TYPE(T, int_t))
+                IS_TYPE(T, double_t) || std::is_integral_v<T>)
     return true;
   return false;
 }
@@ -62,15 +78,19 @@ template <class T> constexpr bool is_basic_type() {
  |                         JObject 类定义开始                          |
  ======================================================================
  */
+/**
+ * JObject 是一个紧凑的 tagged union，一共 16 字节：
+ *   8 字节的值（bool/int/double 直接放在这里，字符串和容器只放指针）
+ * + 4 字节的字符串长度 + 1 字节的类型 + 1 字节的所有权标记 + 1 字节的短字符串长度。
+ * 不超过 inline_size（12）字节的字符串直接放在前 12 个字节（值和长度的位置）里，
+ * 不用分配内存；更长的字符串和 list/dict 放在节点外面，所以 list_t 里的数字是紧密排列的。
+ */
 class JObject {
 public:
-  /* 这里的作用就是定义类型，为了代码简洁 */
-  using value_t = variant<bool_t, int_t, double_t, str_t, list_t, dict_t>;
-  JObject() /*键值 ，默认构造类型默认为null类型*/
-  {
-    m_type = T_NULL;
-    m_value = "null";
-  }
+  /* 不超过这个长度的字符串直接放在节点里 */
+  static constexpr size_t inline_size = 12;
+
+  JObject() = default; /*键值 ，默认构造类型默认为null类型*/
 
   /* TODO：隐式转化在C++里有个坑，只能为类提供一种方向的隐式转化，比如提供了int把转为
    * JObject的隐式转化后，就不能再提供把JObject转为int的隐式转化了，这两种必须要有一个是explicit，否则报错*/
@@ -79,38 +99,105 @@ public:
    * start:下面就是传入不同类型，对构造函数的重写，FIXME：这里写这么多构造函数的意义就是
    * 保证 = 的时候能够 隐式转换
    * ***************************************/
-  JObject(int_t value) { Int(value); }
+  /* 所有的整数类型（int、long、size_t ...）都存成 int_t，
+   * 如果只写 JObject(int_t)，传 int 进来会和 bool、double 的构造函数产生歧义 */
+  template <class I>
+    requires(std::is_integral_v<I> && !IS_TYPE(I, bool_t))
+  JObject(I value) {
+    Int(static_cast<int_t>(value));
+  }
   JObject(bool_t value) { Bool(value); }
   JObject(double_t value) { Double(value); }
   JObject(str_t const &value) { Str(value); }
   JObject(list_t value) { List(std::move(value)); }
   JObject(dict_t value) { Dict(std::move(value)); }
-  void Null() {
-    m_type = T_NULL;
-    m_value = "null";
+  JObject(TYPE type, std::pmr::memory_resource *arena);
+  /* 拷贝出来的 JObject 总是拥有自己的数据：借用的字符串会在拷贝时复制一份，
+   * pmr 容器拷贝时也会换回默认的堆分配，所以从 Document
+   * 里拷贝出来的值在 Document 释放之后依然有效 */
+  JObject(JObject const &other) { copy_from(other); }
+  /* 深拷贝进 arena：容器、长的 key 和字符串都从 arena 里分配（见 Document::Copy），
+   * arena 为空时和上面的拷贝一样 */
+  JObject(JObject const &other, std::pmr::memory_resource *arena) {
+    copy_from(other, arena);
   }
+  JObject(JObject &&other) noexcept { move_from(other); }
+  JObject &operator=(JObject const &other) {
+    if (this != &other) {
+      JObject tmp(other); /*other 可能是自己的子节点，先拷贝再释放自己*/
+      reset();
+      move_from(tmp);
+    }
+    return *this;
+  }
+  JObject &operator=(JObject &&other) noexcept {
+    if (this != &other) {
+      JObject tmp(std::move(other)); /*同上，other 可能是自己的子节点*/
+      reset();
+      move_from(tmp);
+    }
+    return *this;
+  }
+  ~JObject() { reset(); }
+
+  void Null() { reset(); }
   void Int(int_t value) {
-    m_value = value;
+    reset();
+    m_int = value;
     m_type = T_INT;
   }
   void Bool(bool_t value) {
-    m_value = value;
+    reset();
+    m_bool = value;
     m_type = T_BOOL;
   }
   void Double(double_t value) {
+    reset();
+    m_double = value;
     m_type = T_DOUBLE;
-    m_value = value;
   }
   void Str(string_view value) {
-    m_value = string(value);
+    /*先拷贝再释放，value 有可能指向自己原来的字符串*/
+    if (!value.empty() && value.size() <= inline_size) {
+      char buf[inline_size];
+      std::memcpy(buf, value.data(), value.size());
+      reset();
+      std::memcpy(inline_data(), buf, value.size());
+      m_inline_len = static_cast<uint8_t>(value.size());
+      m_type = T_STR;
+      return;
+    }
+    char *data = value.empty() ? nullptr : new char[check_len(value)];
+    if (data)
+      std::memcpy(data, value.data(), value.size());
+    reset();
+    m_str = data;
+    m_len = static_cast<uint32_t>(value.size());
     m_type = T_STR;
   }
+  /**
+   * 借用外部缓冲区中的字符串，不发生拷贝（零拷贝解析和 Document 用）。
+   * 调用者必须保证缓冲区的生命周期长于这个 JObject。
+   * @param value
+   */
+  void StrRef(str_view_t value) {
+    check_len(value);
+    reset();
+    m_str = value.data();
+    m_len = static_cast<uint32_t>(value.size());
+    m_type = T_STR;
+    m_borrowed = true;
+  }
   void List(list_t value) {
-    m_value = std::move(value);
+    auto list = new list_t(std::move(value));
+    reset();
+    m_list = list;
     m_type = T_LIST;
   }
   void Dict(dict_t value) {
-    m_value = std::move(value);
+    auto dict = new dict_t(std::move(value));
+    reset();
+    m_dict = dict;
     m_type = T_DICT;
   }
   /************************
@@ -121,51 +208,79 @@ public:
  * @funtion 如果json的格式有错误，都是抛出这个异常*/
 #define THROW_GET_ERROR(erron)                                                 \
   throw std::logic_error("type error in get " #erron " value!")
+private:
   /**
-   * 获取 JObject 内部的 任意类型数据（泛型）
-   * 内部有调用 value()方法得到对应的数据指针，而
-   * Value()方法则负责将指针强转为对应类型，
-   * 其内部也错误处理，防止处理指针的意外宕机。
-   * @tparam V
-   * @return
+   * Value() 的实现，const 和非 const 共用：Self 是 const JObject 时
+   * 返回的引用也是 const 的
    */
-  template <class V> V &Value() {
+  template <class V, class Self> static decltype(auto) value(Self &self) {
     /*下面的if constexpr 主要是为了安全检查，防止莫名其妙的宕机行为*/
     if constexpr (IS_TYPE(V, str_t)) {
-      if (m_type != T_STR)
+      if (self.m_type != T_STR)
+        THROW_GET_ERROR(string);
+      /*返回一份拷贝（节点里没有 std::string 可以引用），改了不会写回节点，修改用 Str()*/
+      return str_t(self.str_view());
+    } else if constexpr (IS_TYPE(V, str_view_t)) {
+      if (self.m_type != T_STR)
         THROW_GET_ERROR(string);
+      return self.str_view();
     } else if constexpr (IS_TYPE(V, bool_t)) {
-      if (m_type != T_BOOL)
+      if (self.m_type != T_BOOL)
         THROW_GET_ERROR(BOOL);
+      return (self.m_bool); /*加括号，decltype(auto) 推导出的是引用*/
     } else if constexpr (IS_TYPE(V, int_t)) {
-      if (m_type != T_INT)
+      if (self.m_type != T_INT)
+        THROW_GET_ERROR(INT);
+      return (self.m_int);
+    } else if constexpr (std::is_integral_v<V>) {
+      /*其他的整数类型（比如 from(key, int)），检查范围之后返回一份拷贝*/
+      if (self.m_type != T_INT)
         THROW_GET_ERROR(INT);
+      if (!std::in_range<V>(self.m_int))
+        throw std::logic_error("integer out of range in JObject::Value()");
+      return static_cast<V>(self.m_int);
     } else if constexpr (IS_TYPE(V, double_t)) {
-      if (m_type != T_DOUBLE)
+      if (self.m_type != T_DOUBLE)
         THROW_GET_ERROR(DOUBLE);
+      return (self.m_double);
     } else if constexpr (IS_TYPE(V, list_t)) {
-      if (m_type != T_LIST)
+      if (self.m_type != T_LIST)
         THROW_GET_ERROR(LIST);
+      /*m_list 是指针，const 不会传递到它指向的容器，要自己加上*/
+      using list_ref = std::conditional_t<std::is_const_v<Self>,
+                                          list_t const &, list_t &>;
+      return static_cast<list_ref>(*self.m_list);
     } else if constexpr (IS_TYPE(V, dict_t)) {
-      if (m_type != T_DICT)
+      if (self.m_type != T_DICT)
         THROW_GET_ERROR(DICT);
+      using dict_ref = std::conditional_t<std::is_const_v<Self>,
+                                          dict_t const &, dict_t &>;
+      return static_cast<dict_ref>(*self.m_dict);
+    } else {
+      static_assert(IS_TYPE(V, void), "unknown type in JObject::Value()");
     }
-    /*这里 value()返回的是对应类型数据的指针，再将他转为 void*
-     * FIXME:这样做的目的：因为void*指针可以转任意类型的指针 */
-    void *v = value();
-    if (v == nullptr) /*如果没获取到指针*/
-      throw std::logic_error("unknown type in JObject::Value()");
-    return *((V *)v);
-    /*FIXME: V是泛型，这里将 void* 转为V类型的指针，再解引用，所以最终返回的是
-     * 一个引用 */
   }
+
+public:
+  /**
+   * 获取 JObject 内部的 任意类型数据（泛型）
+   * bool/int/double/list/dict 返回的是节点里数据的引用；
+   * 字符串在节点里只存了指针和长度，所以 Value<str_t>() 返回一份拷贝
+   * （修改它不会改到节点，修改字符串用 Str()），不想拷贝的话用 Value<str_view_t>()。
+   * const 的 JObject 返回的是 const 引用（比如 DocumentCache 里共享的文档）。
+   * @tparam V
+   * @return
+   */
+  template <class V> decltype(auto) Value() { return value<V>(*this); }
+  template <class V> decltype(auto) Value() const { return value<V>(*this); }
   /**
    * 返回JObject的数据类型 type
    * @return
    */
-  TYPE Type() { return m_type; }
+  TYPE Type() const { return static_cast<TYPE>(m_type); }
 
-  string ToString();
+  string ToString() const;
+  template <class Sink> void Write(Sink &out) const;
   /**
    * 为list类型的数据定义一个push_back方法
    * 将item这个JObject对象压入this->list最后。
@@ -194,29 +309,74 @@ public:
    * 重载了 下标运算符，使得 dict的类型可以直接 dict[i] = xx;
    * 可以使得一个类的对象像数组一样访问它的成员，这可以增加代码的可读性和可维护性。
    *
-   * @param key string const &key 是一个
-   常引用，它指向一个不可变的string对象，不能通过它修改对象的值1。 const string
-   &key 是一个 常对象，它本身是一个不可变的string对象，也不能修改它的值2。
-                    两者都可以作为函数参数传递，但是 常引用
-   可以避免拷贝开销，并且保证实参不被修改
+   * @param key 用 string_view 接收，字面量和 string
+   都可以直接传进来，查找时不需要拷贝，只有插入新 key 时才会构造 dict_key_t
    * @return
    */
-  JObject &operator[](string const &key) {
+  JObject &operator[](string_view key) {
     if (m_type == T_DICT) {
-      auto &dict = Value<dict_t>();
-      return dict[key];
+      /*先用 string_view 直接查找，找不到才构造 key 插入（和 map[] 语义一样）*/
+      return Value<dict_t>()[key];
     }
     throw std::logic_error("not dict type! JObject::opertor[]()");
   }
+  /**
+   * 只查找不插入：和 operator[] 不同，找不到 key（或者不是 dict）时返回 nullptr，
+   * dict 不会被修改。路径很深、要反复查找的话用 Pointer（见 Pointer.h）
+   * @param key
+   * @return
+   */
+  JObject *Find(string_view key) {
+    if (m_type != T_DICT)
+      return nullptr;
+    auto it = m_dict->find(key);
+    return it != m_dict->end() ? &it->second : nullptr;
+  }
+  JObject const *Find(string_view key) const {
+    return const_cast<JObject *>(this)->Find(key);
+  }
 
 private:
-  // 根据类型获取值的地址，直接硬转为void*类型，然后外界调用Value函数进行类型的强转
-  void *value();
+  static size_t check_len(string_view value) {
+    if (value.size() > UINT32_MAX)
+      throw std::length_error("string too long in JObject");
+    return value.size();
+  }
+  /* 短字符串占用值和长度的位置，也就是节点的前 12 个字节 */
+  char *inline_data() {
+    static_assert(offsetof(JObject, m_type) == inline_size,
+                  "inline string must end right before m_type");
+    return reinterpret_cast<char *>(this);
+  }
+  const char *inline_data() const {
+    return reinterpret_cast<const char *>(this);
+  }
+  str_view_t str_view() const {
+    return m_inline_len ? str_view_t(inline_data(), m_inline_len)
+                        : str_view_t(m_str, m_len);
+  }
+  void reset();
+  void copy_from(JObject const &other,
+                 std::pmr::memory_resource *arena = nullptr);
+  void move_from(JObject &other);
   /* JObject需要两种数据，第一个就是 tag ： 标识了当前存的是什么样的数据，
    *                     第二个是 实际存储的数据*/
-  TYPE m_type;     /* 枚举类型 */
-  value_t m_value; /* variant类型，存json的键值实际数据  */
+  union {
+    bool_t m_bool;
+    int_t m_int;
+    double_t m_double;
+    const char *m_str{nullptr}; /*字符串的数据，不以 '\0' 结尾*/
+    list_t *m_list;
+    dict_t *m_dict;
+  };
+  uint32_t m_len{};       /*字符串的长度*/
+  uint8_t m_type{T_NULL}; /*TYPE 枚举，用一个字节存*/
+  /*为 true 时数据不归自己管（借用的字符串或者 arena 里的容器），析构时不释放*/
+  bool m_borrowed{false};
+  /*不为 0 时字符串直接放在节点里（见 inline_data），这是它的长度*/
+  uint8_t m_inline_len{0};
 };
+static_assert(sizeof(JObject) <= 16, "JObject should stay 16 bytes");
 /*
  ======================================================================
  |                         JObject 类定义结束                          |
@@ -224,92 +384,206 @@ private:
  */
 
 /* FIXME:下面是写的方法 */
-void *JObject::value() {
-  /*调用get_if得到对应的数据指针（std::variant 获取数据的一种方式）
-   * get得到的是 对象的引用 ，如果获取不到，则抛出异常，get_if
-   *获取对象的指针，如果获取不到则返回 nullptr
-   *FIXME: 使用get_if的原因是:
-   *这个异常的处理可以由你自己来设定提示，而不是对着底层的get提示而摸不着头脑。*/
-  switch (m_type) { /*根据类型获取值*/
-  case T_NULL: /*前期定义的时候，我们把json的null定义为 string 类型*/
-    return get_if<str_t>(&m_value);
-  case T_BOOL:
-    return get_if<bool_t>(&m_value);
-  case T_INT:
-    return get_if<int_t>(&m_value);
-  case T_DOUBLE:
-    return get_if<double_t>(&m_value);
+/**
+ * 创建一个空的 list 或 dict，容器本身和它的元素都从 arena 里分配。
+ * arena 为空时就在堆上创建，和 JObject(list_t()) 一样。
+ * @param type 只能是 T_LIST 或 T_DICT
+ * @param arena
+ */
+inline JObject::JObject(TYPE type, std::pmr::memory_resource *arena) {
+  if (type != T_LIST && type != T_DICT)
+    throw std::logic_error("only list or dict can be created in an arena");
+  m_type = type;
+  if (arena == nullptr) { /*没有 arena 就在堆上创建，由自己释放*/
+    if (type == T_LIST)
+      m_list = new list_t();
+    else
+      m_dict = new dict_t();
+    return;
+  }
+  if (type == T_LIST)
+    m_list = new (arena->allocate(sizeof(list_t), alignof(list_t)))
+        list_t(arena);
+  else
+    m_dict = new (arena->allocate(sizeof(dict_t), alignof(dict_t)))
+        dict_t(arena);
+  m_borrowed = true; /*arena 里的容器随 arena 一起释放*/
+}
+
+/**
+ * 释放自己拥有的数据，变回 null
+ */
+inline void JObject::reset() {
+  if (!m_borrowed) {
+    switch (m_type) {
+    case T_STR:
+      if (!m_inline_len)
+        delete[] m_str;
+      break;
+    case T_LIST:
+      delete m_list;
+      break;
+    case T_DICT:
+      delete m_dict;
+      break;
+    default:
+      break;
+    }
+  }
+  m_str = nullptr;
+  m_len = 0;
+  m_type = T_NULL;
+  m_borrowed = false;
+  m_inline_len = 0;
+}
+
+/**
+ * 深拷贝，拷贝出来的数据都在堆上，由自己释放；
+ * arena 不为空时都放进 arena 里，随 arena 一起释放
+ * @param other
+ * @param arena
+ */
+inline void JObject::copy_from(JObject const &other,
+                               std::pmr::memory_resource *arena) {
+  switch (other.m_type) {
+  case T_STR:
+    if (arena && !other.m_inline_len && other.m_len) {
+      char *data = static_cast<char *>(arena->allocate(other.m_len, 1));
+      std::memcpy(data, other.m_str, other.m_len);
+      StrRef({data, other.m_len});
+    } else {
+      Str(other.str_view());
+    }
+    break;
   case T_LIST:
-    return get_if<list_t>(&m_value);
+    if (arena) {
+      JObject list(T_LIST, arena);
+      list.m_list->reserve(other.m_list->size());
+      for (auto &item : *other.m_list)
+        list.m_list->emplace_back(item, arena);
+      move_from(list);
+    } else {
+      m_list = new list_t(*other.m_list);
+      m_type = T_LIST;
+    }
+    break;
   case T_DICT:
-    return get_if<dict_t>(&m_value);
-  case T_STR:
-    return std::get_if<str_t>(&m_value);
-  default:
-    return nullptr;
+    if (arena) { /*key 由 arena 里的 dict 自己拷贝进 arena（见 make_key）*/
+      JObject dict(T_DICT, arena);
+      dict.m_dict->reserve(other.m_dict->size());
+      for (auto &[key, value] : *other.m_dict)
+        dict.m_dict->try_emplace(key.view(), value, arena);
+      move_from(dict);
+    } else {
+      m_dict = new dict_t(*other.m_dict);
+      m_type = T_DICT;
+    }
+    break;
+  default: /*标量直接按位拷贝整个 union*/
+    std::memcpy(&m_double, &other.m_double, sizeof(m_double));
+    m_len = other.m_len;
+    m_type = other.m_type;
+    break;
   }
 }
-/*用于简化 指针强转为任意类型（前提：value得是 void* ） 过程的宏*/
-#define GET_VALUE(type) *((type *)value)
+
+/**
+ * 把 other 的数据（包括所有权）整个拿过来，other 变成 null
+ * @param other
+ */
+inline void JObject::move_from(JObject &other) {
+  /*union 里的成员都不超过 8 字节，和 m_len 一起按位拷过来（短字符串也就一起拷过来了）*/
+  std::memcpy(&m_double, &other.m_double, sizeof(m_double));
+  m_len = other.m_len;
+  m_type = other.m_type;
+  m_borrowed = other.m_borrowed;
+  m_inline_len = other.m_inline_len;
+  other.m_str = nullptr;
+  other.m_len = 0;
+  other.m_type = T_NULL;
+  other.m_borrowed = false;
+  other.m_inline_len = 0;
+}
+
 /**
  * 序列化
- * 把JObject转化为string类型的数据，相当于把序列化的过程反推一遍
+ * 把JObject转化为string类型的数据，相当于把序列化的过程反推一遍。
+ * 打开了统计（见 Stats.h）时记录输出的字节数和耗时
  * @return
  */
-std::string JObject::ToString() {
-  void *value = this->value();
-  std::ostringstream OutStream; /*定义输出流，向字符串写入数据*/
+inline std::string JObject::ToString() const {
+  std::string out;
+  if (Instrument::Enabled()) [[unlikely]] {
+    Stats stats;
+    double start = Instrument::Now();
+    Write(out);
+    stats.serialize_seconds = Instrument::Now() - start;
+    stats.serializes = 1;
+    stats.bytes_out = out.size();
+    Instrument::Record(stats);
+    return out;
+  }
+  Write(out);
+  return out;
+}
+
+/**
+ * 序列化到 out 的末尾。整棵树只往同一个缓冲区里追加，
+ * 不再给每个节点创建 ostringstream、返回临时的 string 再拼起来。
+ * @tparam Sink 需要有 append(const char *, size_t) 和 push_back(char)，
+ *              比如 std::string；也可以是自己写的、写满了就刷到文件或 socket 的缓冲区
+ * @param out
+ */
+template <class Sink> void JObject::Write(Sink &out) const {
   switch (m_type) {
   case T_NULL:
-    OutStream << "null";
+    out.append("null", 4);
     break;
   case T_BOOL:
-    if (GET_VALUE(bool))
-      OutStream << "true";
+    if (m_bool)
+      out.append("true", 4);
     else
-      OutStream << "false";
+      out.append("false", 5);
     break;
-  case T_INT:
-    OutStream << GET_VALUE(int);
+  case T_INT: /* 数字的格式化见 Number.h */
+    num::write_int(out, m_int);
     break;
   case T_DOUBLE:
-    OutStream << GET_VALUE(double);
+    num::write_double(out, m_double);
     break;
-  case T_STR:
-    OutStream << '\"' << GET_VALUE(string) << '\"';
+  case T_STR: /* 需要转义的字符在这里转义，两边的引号也由 escape 输出 */
+    esc::escape(str_view(), out);
     break;
   case T_LIST: {
-    /* FIXME：如果是列表的话，只需要遍历他的每一个元素，递归调用ToString()方法*/
-    list_t &list = GET_VALUE(list_t);
-    OutStream << '['; /*注意在最开始的时候加上 左括号 `[` */
-    for (auto i = 0; i < list.size(); i++) {
-      /*遍历列表*/
-      if (i != list.size() - 1) {
-        OutStream << ((list[i]).ToString());
-        OutStream << ','; /*注意，在中间还需要输出 ， 逗号*/
-      } else
-        OutStream << ((list[i]).ToString()); /*如果是最后一个元素的话，不用输出
-                                   逗号 了*/
+    out.push_back('[');
+    bool first = true;
+    for (auto &item : *m_list) {
+      if (!first) /*在中间还需要输出 ， 逗号*/
+        out.push_back(',');
+      first = false;
+      item.Write(out);
     }
-    OutStream << ']'; /*注意在最结束的时候加上 右括号 `[` */
+    out.push_back(']');
     break;
   }
-  case T_DICT: { /*如果是字典*/
-    dict_t &dict = GET_VALUE(dict_t);
-    OutStream << '{'; /*先输出 { */
-    for (auto it = dict.begin(); it != dict.end(); ++it) {
-      if (it != dict.begin()) /*为了保证最后的json格式正确，中间要输出逗号*/
-        OutStream << ',';
-      /* first是key，second是value。对于key，要使用" " 包裹，然后再输出冒号 : */
-      OutStream << '\"' << it->first << "\":" << it->second.ToString();
+  case T_DICT: {
+    out.push_back('{');
+    bool first = true;
+    for (auto &[key, value] : *m_dict) {
+      if (!first)
+        out.push_back(',');
+      first = false;
+      /* key 和字符串一样要转义、用 " " 包裹，然后再输出冒号 : */
+      esc::escape(key, out);
+      out.push_back(':');
+      value.Write(out);
     }
-    OutStream << '}'; /* 输出 } ，结束*/
+    out.push_back('}');
     break;
   }
   default:
-    return ""; /*啥都没有，输出空即可*/
+    break; /*啥都没有，输出空即可*/
   }
-  return OutStream.str();
 }
 } // namespace json
 
@@ -0,0 +1,260 @@
+#ifndef MYJSON_PARSER_LAZY_H
+#define MYJSON_PARSER_LAZY_H
+
+#include "Parser.h"
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+namespace json {
+class LazyDocument;
+/*
+ ======================================================================
+ |                        LazyValue 类定义开始                          |
+ ======================================================================
+ */
+/**
+ * 按需解析的值：只记录它在输入里的位置，什么都不解析。
+ * operator[] 只向前扫描到要找的 key 或下标，中间的值用括号匹配整个跳过；
+ * 标量只有调用 Value() 时才解码。
+ * 每次访问都从这个值的开头重新扫描，所以适合只读几个字段的场景，
+ * 要遍历全部内容的话用 ToJObject() 一次解析出来更快。
+ */
+class LazyValue {
+public:
+  TYPE Type() const;
+  LazyValue operator[](string_view key) const;
+  LazyValue operator[](size_t index) const;
+  /* 和 operator[] 一样，但是找不到（或者类型不对）时返回空，不抛异常 */
+  std::optional<LazyValue> Find(string_view key) const;
+  std::optional<LazyValue> Find(size_t index) const;
+  size_t Size() const;
+  /**
+   * 和 JObject::Value 一样，类型不对时抛出异常。
+   * str_view_t 在有转义时指向解码缓冲区，只在下一次访问这个文档之前有效
+   */
+  template <class V> V Value() const;
+  /* 把这个值（包括所有子节点）解析成 JObject */
+  JObject ToJObject() const;
+
+private:
+  friend class LazyDocument;
+  LazyValue(LazyDocument *doc, size_t pos) : m_doc(doc), m_pos(pos) {}
+  Parser &parser() const;
+  char enter(char open) const;
+
+  LazyDocument *m_doc;
+  size_t m_pos; /* 值的第一个字符在输入中的位置 */
+};
+/*
+ ======================================================================
+ |                        LazyValue 类定义结束                          |
+ ======================================================================
+ */
+
+/**
+ * 按需解析的文档，不拷贝输入，content 必须比它（以及取出来的 LazyValue）活得久。
+ * 所有 LazyValue 共用这一个 Parser，所以一个文档不能同时被多个线程访问。
+ */
+class LazyDocument {
+public:
+  explicit LazyDocument(string_view content, SYNTAX syntax = SYNTAX_STRICT) {
+    m_parser.init(content);
+    m_parser.set_syntax(syntax);
+  }
+  LazyDocument(LazyDocument const &) = delete;
+  LazyDocument &operator=(LazyDocument const &) = delete;
+
+  LazyValue Root() { return {this, 0}; }
+
+private:
+  friend class LazyValue;
+  Parser m_parser;
+};
+
+inline Parser &LazyValue::parser() const {
+  Parser &parser = m_doc->m_parser;
+  parser.seek(m_pos);
+  return parser;
+}
+
+/**
+ * 检查这个值是不是以 open 开头的容器，并且移到第一个元素
+ * @param open [ 或者 {
+ * @return 第一个元素的第一个字符，空容器时是 ] 或者 }
+ */
+inline char LazyValue::enter(char open) const {
+  Parser &p = parser();
+  if (p.get_next_token() != open)
+    throw std::logic_error(open == '{' ? "type error in get DICT value!"
+                                       : "type error in get LIST value!");
+  p.seek(p.pos() + 1);
+  return p.get_next_token();
+}
+
+/**
+ * 只看第一个字符，数字要解析一下才知道是整数还是浮点数
+ * @return
+ */
+inline TYPE LazyValue::Type() const {
+  Parser &p = parser();
+  switch (p.get_next_token()) {
+  case 'n':
+    return T_NULL;
+  case 't':
+  case 'f':
+    return T_BOOL;
+  case '"':
+    return T_STR;
+  case '[':
+    return T_LIST;
+  case '{':
+    return T_DICT;
+  default:
+    return p.parse_number().is_int ? T_INT : T_DOUBLE;
+  }
+}
+
+/**
+ * 在 dict 里找 key，前面的 value 都不解析，直接跳过
+ * @param key
+ * @return 不是 dict 或者没有这个 key 时返回空
+ */
+inline std::optional<LazyValue> LazyValue::Find(string_view key) const {
+  Parser &p = parser();
+  if (p.get_next_token() != '{')
+    return std::nullopt;
+  char ch = enter('{');
+  while (ch != '}') {
+    if (ch != '"')
+      throw std::logic_error("expected string key in parse dict");
+    bool found = p.parse_string() == key;
+    if (p.get_next_token() != ':')
+      throw std::logic_error("expected ':' in parse dict");
+    p.seek(p.pos() + 1);
+    if (found) {
+      p.get_next_token(); /*LazyValue 直接指向 value 的第一个字符*/
+      return LazyValue(m_doc, p.pos());
+    }
+    p.skip_value();
+    ch = p.get_next_token();
+    if (ch == ',') {
+      ch = p.next_after_comma('}');
+    } else if (ch != '}') {
+      throw std::logic_error("expected ',' in parse dict");
+    }
+  }
+  return std::nullopt;
+}
+
+/**
+ * 取 list 的第 index 个元素，前面的元素直接跳过
+ * @param index
+ * @return 不是 list 或者越界时返回空
+ */
+inline std::optional<LazyValue> LazyValue::Find(size_t index) const {
+  Parser &p = parser();
+  if (p.get_next_token() != '[')
+    return std::nullopt;
+  char ch = enter('[');
+  for (size_t i = 0; ch != ']'; i++) {
+    if (i == index)
+      return LazyValue(m_doc, p.pos());
+    p.skip_value();
+    ch = p.get_next_token();
+    if (ch == ',') {
+      ch = p.next_after_comma(']');
+    } else if (ch != ']') {
+      throw std::logic_error("expected ',' in parse list");
+    }
+  }
+  return std::nullopt;
+}
+
+inline LazyValue LazyValue::operator[](string_view key) const {
+  if (auto value = Find(key))
+    return *value;
+  if (Type() != T_DICT)
+    THROW_GET_ERROR(DICT);
+  throw std::logic_error("key not found in LazyValue::operator[]");
+}
+
+inline LazyValue LazyValue::operator[](size_t index) const {
+  if (auto value = Find(index))
+    return *value;
+  if (Type() != T_LIST)
+    THROW_GET_ERROR(LIST);
+  throw std::logic_error("index out of range in LazyValue::operator[]");
+}
+
+/**
+ * list 的元素个数或者 dict 的 key 的个数，所有元素都只是跳过
+ * @return
+ */
+inline size_t LazyValue::Size() const {
+  Parser &p = parser();
+  char ch = p.get_next_token();
+  if (ch != '[' && ch != '{')
+    throw std::logic_error("type error in LazyValue::Size()");
+  char close = ch == '[' ? ']' : '}';
+  ch = enter(ch);
+  size_t size = 0;
+  while (ch != close) {
+    if (close == '}') { /*跳过 key 和冒号*/
+      p.skip_value();
+      if (p.get_next_token() != ':')
+        throw std::logic_error("expected ':' in parse dict");
+      p.seek(p.pos() + 1);
+    }
+    p.skip_value();
+    size++;
+    ch = p.get_next_token();
+    if (ch == ',') {
+      ch = p.next_after_comma(close);
+    } else if (ch != close) {
+      throw std::logic_error("expected ',' in parse json");
+    }
+  }
+  return size;
+}
+
+template <class V> V LazyValue::Value() const {
+  Parser &p = parser();
+  char ch = p.get_next_token();
+  if constexpr (IS_TYPE(V, bool_t)) {
+    if (ch != 't' && ch != 'f')
+      THROW_GET_ERROR(BOOL);
+    return p.parse_bool();
+  } else if constexpr (std::is_integral_v<V>) {
+    if (ch != '-' && !num::is_digit(ch))
+      THROW_GET_ERROR(INT);
+    num::Number number = p.parse_number();
+    if (!number.is_int)
+      THROW_GET_ERROR(INT);
+    if (!std::in_range<V>(number.i))
+      throw std::logic_error("integer out of range in LazyValue::Value()");
+    return static_cast<V>(number.i);
+  } else if constexpr (IS_TYPE(V, double_t)) {
+    if (ch != '-' && !num::is_digit(ch))
+      THROW_GET_ERROR(DOUBLE);
+    num::Number number = p.parse_number();
+    if (number.is_int)
+      THROW_GET_ERROR(DOUBLE);
+    return number.d;
+  } else if constexpr (IS_TYPE(V, str_t) || IS_TYPE(V, str_view_t)) {
+    if (ch != '"')
+      THROW_GET_ERROR(STRING);
+    return V(p.parse_string());
+  } else {
+    static_assert(IS_TYPE(V, void), "unknown type in LazyValue::Value()");
+  }
+}
+
+inline JObject LazyValue::ToJObject() const {
+  DomBuilder builder;
+  parser().parse_value(builder);
+  return std::move(builder.result());
+}
+} // namespace json
+
+#endif // MYJSON_PARSER_LAZY_H
@@ -0,0 +1,144 @@
+#ifndef MYJSON_PARSER_MAPPEDFILE_H
+#define MYJSON_PARSER_MAPPEDFILE_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace json {
+/*
+ ======================================================================
+ |                       MappedFile 类定义开始                          |
+ ======================================================================
+ */
+/**
+ * 只读地把整个文件映射进内存，Parser 直接在映射的页面上解析，
+ * 不用先读进 std::string（少一次拷贝，也不会同时占两份内存）。
+ * 映射时告诉内核会顺序读完整个文件，让它提前预读。
+ * 析构时解除映射，之后借用它的 string_view 都不能再用了。
+ * 映射期间文件不能被截短或者改写（截短之后再访问会收到 SIGBUS）。
+ */
+class MappedFile {
+public:
+  MappedFile() = default;
+  explicit MappedFile(std::string const &path) { open(path); }
+  ~MappedFile() { close(); }
+  MappedFile(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile const &) = delete;
+  MappedFile(MappedFile &&other) noexcept
+      : m_data(other.m_data), m_size(other.m_size) {
+    other.m_data = nullptr;
+    other.m_size = 0;
+  }
+  MappedFile &operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+      close();
+      m_data = other.m_data;
+      m_size = other.m_size;
+      other.m_data = nullptr;
+      other.m_size = 0;
+    }
+    return *this;
+  }
+
+  void open(std::string const &path);
+  void close();
+  const char *data() const { return m_data; }
+  size_t size() const { return m_size; }
+  std::string_view view() const { return {m_data, m_size}; }
+
+private:
+  const char *m_data{nullptr}; /* 空文件不映射，为 nullptr */
+  size_t m_size{0};
+};
+/*
+ ======================================================================
+ |                       MappedFile 类定义结束                          |
+ ======================================================================
+ */
+
+/**
+ * 映射 path，原来映射的文件先解除
+ * @param path
+ */
+inline void MappedFile::open(std::string const &path) {
+  close();
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    throw std::logic_error("can not open file in MappedFile::open");
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    throw std::logic_error("can not stat file in MappedFile::open");
+  }
+  if (size.QuadPart > 0) {
+    HANDLE mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void *data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)
+                         : nullptr;
+    if (mapping) /*映射的视图会一直持有它，句柄可以先关掉*/
+      CloseHandle(mapping);
+    if (data == nullptr) {
+      CloseHandle(file);
+      throw std::logic_error("can not map file in MappedFile::open");
+    }
+    m_data = static_cast<const char *>(data);
+    m_size = size_t(size.QuadPart);
+  }
+  CloseHandle(file);
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::logic_error("can not open file in MappedFile::open");
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::logic_error("can not stat file in MappedFile::open");
+  }
+  if (st.st_size > 0) {
+    void *data =
+        mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      ::close(fd);
+      throw std::logic_error("can not map file in MappedFile::open");
+    }
+    /*顺序读完整个文件：加大预读，并且马上开始读*/
+    madvise(data, size_t(st.st_size), MADV_SEQUENTIAL);
+    madvise(data, size_t(st.st_size), MADV_WILLNEED);
+    m_data = static_cast<const char *>(data);
+    m_size = size_t(st.st_size);
+  }
+  ::close(fd); /*映射不依赖文件描述符*/
+#endif
+}
+
+inline void MappedFile::close() {
+  if (m_data != nullptr) {
+#if defined(_WIN32)
+    UnmapViewOfFile(m_data);
+#else
+    munmap(const_cast<char *>(m_data), m_size);
+#endif
+  }
+  m_data = nullptr;
+  m_size = 0;
+}
+} // namespace json
+
+#endif // MYJSON_PARSER_MAPPEDFILE_H
@@ -0,0 +1,352 @@
+#ifndef MYJSON_PARSER_NDJSON_H
+#define MYJSON_PARSER_NDJSON_H
+
+#include "Parser.h"
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace json {
+/*
+ ======================================================================
+ |                       NdJsonReader 类定义开始                        |
+ ======================================================================
+ */
+/**
+ * NDJSON（JSON Lines）的读取：每一行是一个独立的 JSON 值。
+ * 输入先按行切开、每 batch_lines 行分成一批，交给几个工作线程并行解析，
+ * 解析结果都回到调用 Read 的线程里交给回调（按行号顺序，或者哪批先解析完先给哪批），
+ * 所以回调不需要是线程安全的。工作线程最多比回调领先几批，解析结果不会无限堆积。
+ * 空行直接跳过；解析失败的行默认抛出异常（带行号），
+ * 打开 skip_errors 时只跳过这一行，交给错误回调，其余的行照常解析。
+ * 打开了统计（见 Stats.h）时，所有行的结果合并起来，在调用 Read/ReadFile 的线程里
+ * 记成一次解析，耗时是整个调用的墙钟时间。
+ * 用到了 std::thread，需要链接线程库（CMake 里是 Threads::Threads）。
+ */
+class NdJsonReader {
+public:
+  struct Options {
+    unsigned threads = 0;     /* 工作线程数，0 表示 hardware_concurrency() */
+    size_t batch_lines = 256; /* 每一批的行数 */
+    bool ordered = true;      /* 是否按行号顺序交给回调 */
+    bool skip_errors = false; /* 为 true 时跳过解析失败的行，否则抛出异常 */
+    size_t chunk_bytes = size_t(16) << 20; /* ReadFile 每次读进来多少字节 */
+    SYNTAX syntax = SYNTAX_STRICT; /* SYNTAX_JSONC 时接受末尾多一个逗号 */
+  };
+  /* 默认的错误回调：什么都不做 */
+  struct IgnoreError {
+    void operator()(size_t, string_view, std::string const &) const {}
+  };
+
+  NdJsonReader() = default;
+  explicit NdJsonReader(Options options) : m_options(options) {}
+
+  /**
+   * 解析内存里的 NDJSON
+   * @param content 解析期间必须一直有效
+   * @param on_value void(size_t line, JObject &value)，行号从 1 开始，value 可以直接 move 走
+   * @param on_error void(size_t line, string_view text, std::string const &what)，
+   *                 只有 skip_errors 时才会调用
+   * @return 解析成功的行数
+   */
+  template <class OnValue, class OnError = IgnoreError>
+  size_t Read(string_view content, OnValue &&on_value,
+              OnError &&on_error = {});
+  /* 和 Read 一样，但是一块一块地读文件，内存里最多只有 chunk_bytes 左右的输入 */
+  template <class OnValue, class OnError = IgnoreError>
+  size_t ReadFile(std::string const &path, OnValue &&on_value,
+                  OnError &&on_error = {});
+  /* 上一次 Read/ReadFile 跳过了多少行解析失败的 */
+  size_t Errors() const { return m_errors; }
+
+private:
+  struct Item {
+    size_t line;
+    string_view text;
+    JObject value;
+    std::string error; /* 为空表示解析成功 */
+  };
+  struct Batch {
+    std::vector<Item> items;
+    bool done = false;
+  };
+
+  unsigned thread_count() const {
+    unsigned threads = m_options.threads;
+    if (threads == 0)
+      threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 1 : threads;
+  }
+  size_t split(string_view content, size_t first_line,
+               std::vector<Batch> &batches) const;
+  /* 打开了统计时，让 parser 的结果累加到 local 里 */
+  void collect(Parser &parser, Stats &local) const {
+    if (m_counted)
+      parser.collect_stats(&local);
+  }
+  void record(size_t bytes, double start);
+  void parse_batch(Parser &parser, Batch &batch) const;
+  template <class OnValue, class OnError>
+  void deliver(Batch &batch, OnValue &on_value, OnError &on_error);
+  template <class OnValue, class OnError>
+  size_t process(string_view content, size_t first_line, OnValue &on_value,
+                 OnError &on_error);
+
+  Options m_options;
+  size_t m_values{0};
+  size_t m_errors{0};
+  bool m_counted{false}; /* 这一次 Read/ReadFile 是否统计 */
+  Stats m_stats;         /* 这一次调用所有行的统计 */
+};
+/*
+ ======================================================================
+ |                       NdJsonReader 类定义结束                        |
+ ======================================================================
+ */
+
+/**
+ * 按 \n 切成行（行尾的 \r 和空白去掉，空行不要），每 batch_lines 行一批
+ * @return 一共有多少行（包括空行），下一块的行号从这里接着算
+ */
+inline size_t NdJsonReader::split(string_view content, size_t first_line,
+                                  std::vector<Batch> &batches) const {
+  size_t batch_lines = m_options.batch_lines ? m_options.batch_lines : 1;
+  const char *p = content.data(), *end = p + content.size();
+  size_t line = first_line;
+  while (p < end) {
+    auto nl = static_cast<const char *>(std::memchr(p, '\n', end - p));
+    if (nl == nullptr)
+      nl = end;
+    string_view text(p, nl - p);
+    while (!text.empty() && (scan::char_table.cls[(uint8_t)text.back()] &
+                             scan::C_WS))
+      text.remove_suffix(1);
+    if (!text.empty()) {
+      if (batches.empty() || batches.back().items.size() == batch_lines) {
+        batches.emplace_back();
+        batches.back().items.reserve(batch_lines);
+      }
+      batches.back().items.push_back({line, text, JObject(), {}});
+    }
+    line++;
+    p = nl + 1;
+  }
+  return line - first_line;
+}
+
+/**
+ * 解析一批里的每一行，失败的行记下错误信息，不影响后面的行
+ * @param parser 每个线程自己的 Parser
+ * @param batch
+ */
+inline void NdJsonReader::parse_batch(Parser &parser, Batch &batch) const {
+  parser.set_syntax(m_options.syntax);
+  for (auto &item : batch.items) {
+    try {
+      parser.init(item.text);
+      item.value = parser.parse();
+      /*一行只能有一个值*/
+      if (parser.pos() < item.text.size())
+        throw std::logic_error("unexpected content after value");
+    } catch (std::exception const &e) {
+      item.value.Null();
+      item.error = e.what();
+      if (item.error.empty())
+        item.error = "parse error";
+    }
+  }
+}
+
+/* 把一批的结果交给回调，在调用 Read 的线程里执行 */
+template <class OnValue, class OnError>
+void NdJsonReader::deliver(Batch &batch, OnValue &on_value,
+                           OnError &on_error) {
+  for (auto &item : batch.items) {
+    if (item.error.empty()) {
+      m_values++;
+      on_value(item.line, item.value);
+    } else if (m_options.skip_errors) {
+      m_errors++;
+      on_error(item.line, item.text, item.error);
+    } else {
+      throw std::logic_error("line " + std::to_string(item.line) + ": " +
+                             item.error);
+    }
+  }
+  std::vector<Item>().swap(batch.items); /*交出去之后马上释放*/
+}
+
+/**
+ * 并行解析一整块输入：工作线程按顺序领取下一批，解析完放进 finished，
+ * 当前线程等着把结果交给回调。工作线程最多领先 window 批。
+ * 回调抛出异常（或者遇到错误的行）时，先让工作线程停下来再把异常抛出去。
+ * @return 这一块一共有多少行
+ */
+template <class OnValue, class OnError>
+size_t NdJsonReader::process(string_view content, size_t first_line,
+                             OnValue &on_value, OnError &on_error) {
+  std::vector<Batch> batches;
+  size_t lines = split(content, first_line, batches);
+  unsigned threads = thread_count();
+  if (threads <= 1 || batches.size() <= 1) { /*单线程直接解析，不用开线程*/
+    Parser parser;
+    collect(parser, m_stats);
+    for (auto &batch : batches) {
+      parse_batch(parser, batch);
+      deliver(batch, on_value, on_error);
+    }
+    return lines;
+  }
+
+  std::mutex mutex;
+  std::condition_variable main_cv, worker_cv;
+  std::deque<size_t> finished; /*ordered 为 false 时，解析完的批的下标*/
+  size_t next = 0, delivered = 0, window = size_t(threads) * 2;
+  bool stop = false;
+  auto worker = [&] {
+    Parser parser;
+    Stats local;
+    collect(parser, local);
+    while (true) {
+      size_t index;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        worker_cv.wait(lock, [&] {
+          return stop || next >= batches.size() || next < delivered + window;
+        });
+        if (stop || next >= batches.size()) {
+          m_stats.Add(local); /*m_stats 也由 mutex 保护*/
+          return;
+        }
+        index = next++;
+      }
+      parse_batch(parser, batches[index]);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        batches[index].done = true;
+        if (!m_options.ordered)
+          finished.push_back(index);
+      }
+      main_cv.notify_one();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  /*不管是正常结束还是抛出异常，都要等工作线程退出*/
+  struct Joiner {
+    std::vector<std::thread> &workers;
+    std::mutex &mutex;
+    std::condition_variable &cv;
+    bool &stop;
+    ~Joiner() {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+      }
+      cv.notify_all();
+      for (auto &worker : workers)
+        worker.join();
+    }
+  } joiner{workers, mutex, worker_cv, stop};
+  for (unsigned t = 0; t < threads; t++)
+    workers.emplace_back(worker);
+
+  for (size_t n = 0; n < batches.size(); n++) {
+    size_t index;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (m_options.ordered) {
+        main_cv.wait(lock, [&] { return batches[n].done; });
+        index = n;
+      } else {
+        main_cv.wait(lock, [&] { return !finished.empty(); });
+        index = finished.front();
+        finished.pop_front();
+      }
+    }
+    deliver(batches[index], on_value, on_error);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      delivered++;
+    }
+    worker_cv.notify_all();
+  }
+  return lines;
+}
+
+/**
+ * 一次 Read/ReadFile 结束，把所有行的统计记成一次解析
+ * @param bytes 一共读了多少字节
+ * @param start 开始的时间
+ */
+inline void NdJsonReader::record(size_t bytes, double start) {
+  m_stats.parses = 1;
+  m_stats.bytes_in = bytes;
+  m_stats.parse_seconds = Instrument::Now() - start;
+  Instrument::Record(m_stats);
+}
+
+template <class OnValue, class OnError>
+size_t NdJsonReader::Read(string_view content, OnValue &&on_value,
+                          OnError &&on_error) {
+  m_values = m_errors = 0;
+  m_stats = Stats();
+  m_counted = Instrument::Enabled();
+  double start = m_counted ? Instrument::Now() : 0;
+  process(content, 1, on_value, on_error);
+  if (m_counted)
+    record(content.size(), start);
+  return m_values;
+}
+
+/**
+ * 每次读 chunk_bytes 字节，只解析到最后一个 \n 为止，剩下半行留到下一次。
+ * 留下来的半行里没有 \n，所以只用在新读进来的部分里找
+ */
+template <class OnValue, class OnError>
+size_t NdJsonReader::ReadFile(std::string const &path, OnValue &&on_value,
+                              OnError &&on_error) {
+  std::ifstream fin(path, std::ios::binary);
+  if (!fin)
+    throw std::logic_error("can not open file in NdJsonReader::ReadFile");
+  m_values = m_errors = 0;
+  m_stats = Stats();
+  m_counted = Instrument::Enabled();
+  double start = m_counted ? Instrument::Now() : 0;
+  size_t chunk = m_options.chunk_bytes ? m_options.chunk_bytes : 1;
+  std::string buffer;
+  size_t line = 1, bytes = 0;
+  while (true) {
+    size_t old = buffer.size();
+    buffer.resize(old + chunk);
+    fin.read(buffer.data() + old, std::streamsize(chunk));
+    buffer.resize(old + size_t(fin.gcount()));
+    bytes += size_t(fin.gcount());
+    bool eof = !fin;
+    size_t cut = buffer.size();
+    if (!eof) {
+      cut = string_view(buffer).substr(old).rfind('\n');
+      if (cut == string_view::npos) /*一行比 chunk 还长，接着读*/
+        continue;
+      cut += old + 1;
+    }
+    line += process(string_view(buffer.data(), cut), line, on_value, on_error);
+    buffer.erase(0, cut);
+    if (eof)
+      break;
+  }
+  if (m_counted)
+    record(bytes, start);
+  return m_values;
+}
+} // namespace json
+
+#endif // MYJSON_PARSER_NDJSON_H
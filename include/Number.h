@@ -0,0 +1,166 @@
+#ifndef MYJSON_PARSER_NUMBER_H
+#define MYJSON_PARSER_NUMBER_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+
+namespace json {
+namespace num {
+/**
+ * 解析出来的数字：能用 int64 精确表示的整数放在 i 里，其余的放在 d 里
+ */
+struct Number {
+  bool is_int;
+  int64_t i;
+  double d;
+};
+
+/* 10 的 0~22 次方都能被 double 精确表示 */
+inline constexpr double pow10_table[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+inline bool is_digit(char ch) { return ch >= '0' && ch <= '9'; }
+
+/**
+ * 解析 [p, end) 开头的一个 JSON 数字：-?\d+(\.\d+)?([eE][+-]?\d+)?
+ * 1. 整数部分和小数部分一起累加到 uint64 的 mantissa 里，只扫描一遍；
+ * 2. 没有小数点和指数、并且不超过 int64 的，直接就是整数；
+ * 3. mantissa 不超过 2^53、十进制指数在 ±22 之内时，一次乘除就是精确结果；
+ * 4. 其他情况交给 std::from_chars，它保证正确舍入，而且和 locale 无关。
+ * @param p 数字的第一个字符
+ * @param end 输入的末尾，不要求以 '\0' 结尾
+ * @param out 解析结果
+ * @return 数字之后的第一个字符
+ */
+inline const char *parse_number(const char *p, const char *end, Number &out) {
+  const char *begin = p;
+  bool negative = false;
+  if (p != end && *p == '-') {
+    negative = true;
+    p++;
+  }
+  if (p == end || !is_digit(*p))
+    throw std::logic_error("invalid character in number");
+
+  uint64_t mantissa = 0;
+  int digits = 0;     /* 累加进 mantissa 的有效数字个数 */
+  int exp10 = 0;      /* 十进制指数 */
+  bool exact = true;  /* mantissa 是否保存了所有的数字 */
+  /* 整数部分 */
+  for (; p != end && is_digit(*p); p++) {
+    if (digits < 19) {
+      mantissa = mantissa * 10 + (*p - '0');
+      if (mantissa != 0)
+        digits++;
+    } else {
+      exp10++; /* 放不下的数字先记在指数里 */
+      exact = false;
+    }
+  }
+  bool is_int = true;
+  /* 小数部分 */
+  if (p != end && *p == '.') {
+    is_int = false;
+    p++;
+    if (p == end || !is_digit(*p))
+      throw std::logic_error(
+          "at least one digit required in parse float part!");
+    for (; p != end && is_digit(*p); p++) {
+      if (digits < 19) {
+        mantissa = mantissa * 10 + (*p - '0');
+        if (mantissa != 0)
+          digits++;
+        exp10--;
+      } else {
+        exact = false;
+      }
+    }
+  }
+  /* 指数部分 */
+  if (p != end && (*p == 'e' || *p == 'E')) {
+    is_int = false;
+    p++;
+    bool exp_negative = false;
+    if (p != end && (*p == '+' || *p == '-')) {
+      exp_negative = *p == '-';
+      p++;
+    }
+    if (p == end || !is_digit(*p))
+      throw std::logic_error("at least one digit required in exponent!");
+    int exp = 0;
+    for (; p != end && is_digit(*p); p++)
+      if (exp < 100000) /* 再大也只是 inf 或者 0 了，防止溢出 */
+        exp = exp * 10 + (*p - '0');
+    exp10 += exp_negative ? -exp : exp;
+  }
+
+  /* 整数：没有丢掉任何数字，并且在 int64 范围内 */
+  if (is_int && exact) {
+    constexpr auto max = uint64_t(std::numeric_limits<int64_t>::max());
+    if (!negative && mantissa <= max) {
+      out = {true, int64_t(mantissa), 0};
+      return p;
+    }
+    if (negative && mantissa <= max + 1) {
+      out = {true, int64_t(0 - mantissa), 0};
+      return p;
+    }
+  }
+  /* 快速路径（Clinger）：mantissa 和 10^|exp10| 都能被 double 精确表示，
+   * 一次乘法或除法只有一次舍入，结果就是正确舍入的 */
+  if (exact && mantissa <= (uint64_t(1) << 53) && exp10 >= -22 &&
+      exp10 <= 22) {
+    double d = double(mantissa);
+    d = exp10 < 0 ? d / pow10_table[-exp10] : d * pow10_table[exp10];
+    out = {false, 0, negative ? -d : d};
+    return p;
+  }
+  /* 慢速路径：from_chars 不接受开头的 +，但是接受 -，正好和 JSON 一致 */
+  double d = 0;
+  auto [ptr, ec] = std::from_chars(begin, p, d);
+  if (ec == std::errc::result_out_of_range) {
+    /* 太小的数下溢成 0，太大的数报错 */
+    if (exp10 + digits > 0)
+      throw std::logic_error("number too big");
+    d = negative ? -0.0 : 0.0;
+  } else if (ec != std::errc() || ptr != p) {
+    throw std::logic_error("invalid number");
+  }
+  out = {false, 0, d};
+  return p;
+}
+
+/**
+ * 把整数写到 out 的末尾
+ * @tparam Sink 需要有 append(const char *, size_t)
+ */
+template <class Sink, class I> void write_int(Sink &out, I value) {
+  char buf[24]; /* 64 位整数最多 20 个字符 */
+  auto res = std::to_chars(buf, buf + sizeof(buf), value);
+  out.append(buf, res.ptr - buf);
+}
+
+/**
+ * 把浮点数写到 out 的末尾。to_chars 不指定精度时输出能精确还原这个 double 的最短形式，
+ * 1.0 会输出成 1，补上 .0，否则再解析回来就变成整数了
+ */
+template <class Sink> void write_double(Sink &out, double value) {
+  char buf[32];
+  auto res = std::to_chars(buf, buf + sizeof(buf) - 2, value);
+  if (std::find_if(buf, res.ptr, [](char ch) {
+        return ch == '.' || ch == 'e' || ch == 'n' || ch == 'i';
+      }) == res.ptr) {
+    *res.ptr++ = '.';
+    *res.ptr++ = '0';
+  }
+  out.append(buf, res.ptr - buf);
+}
+} // namespace num
+} // namespace json
+
+#endif // MYJSON_PARSER_NUMBER_H
@@ -0,0 +1,283 @@
+#ifndef MYJSON_PARSER_PARALLELPARSER_H
+#define MYJSON_PARSER_PARALLELPARSER_H
+
+#include "Parser.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace json {
+/*
+ ======================================================================
+ |                     ParallelParser 类定义开始                        |
+ ======================================================================
+ */
+/**
+ * 多线程解析一个很大的文档（通常是顶层一个巨大的数组，比如导出的快照）：
+ *   1. 单线程快速扫描一遍，用 Scanner 的位图跟踪字符串和转义，
+ *      只看字符串外面的括号和逗号，找出顶层数组每个元素的边界；
+ *   2. 元素按顺序分给几个工作线程，每个线程用自己的 Parser 解析；
+ *   3. 每个元素直接放进结果 list_t 里自己的位置，顺序和输入一致。
+ * 顶层不是数组、输入比 min_parallel_bytes 小、字符串外面有 // 注释、
+ * 或者第一步发现括号不配对时，直接退回 Parser::FromString。
+ * 并行解析时有多个元素出错的话，抛出的是下标最小的那个元素的异常，和单线程解析先遇到的一样。
+ * 打开了统计（见 Stats.h）时，各个线程解析元素的结果合并起来，
+ * 在调用 Parse 的线程里记成一次解析，耗时是整个 Parse 的墙钟时间。
+ * 用到了 std::thread，需要链接线程库（CMake 里是 Threads::Threads）。
+ */
+class ParallelParser {
+public:
+  struct Options {
+    unsigned threads = 0; /* 工作线程数，0 表示 hardware_concurrency() */
+    size_t min_parallel_bytes = size_t(1) << 20; /* 比这个小的输入单线程解析 */
+    bool borrow = false; /* 和 FromStringView 一样，字符串值借用输入 */
+    SYNTAX syntax = SYNTAX_STRICT; /* SYNTAX_JSONC 时接受末尾多一个逗号 */
+  };
+
+  ParallelParser() = default;
+  explicit ParallelParser(Options options) : m_options(options) {}
+
+  JObject Parse(string_view content);
+  /* 上一次 Parse 的顶层数组有多少个元素，退回单线程解析时为 0 */
+  size_t Elements() const { return m_elements; }
+
+private:
+  bool split(string_view content, std::vector<string_view> &elements) const;
+  /* 去掉元素后面的空白，这样解析完之后 pos() 没到结尾就说明后面还有别的内容 */
+  static string_view trim_right(const char *data, size_t size) {
+    while (size > 0 && (scan::char_table.cls[(uint8_t)data[size - 1]] &
+                        scan::C_WS))
+      size--;
+    return {data, size};
+  }
+  JObject parse_sequential(string_view content) const {
+    return m_options.borrow
+               ? Parser::FromStringView(content, m_options.syntax)
+               : Parser::FromString(content, m_options.syntax);
+  }
+  unsigned thread_count() const {
+    unsigned threads = m_options.threads;
+    if (threads == 0)
+      threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 1 : threads;
+  }
+
+  Options m_options;
+  size_t m_elements{0};
+};
+/*
+ ======================================================================
+ |                     ParallelParser 类定义结束                        |
+ ======================================================================
+ */
+
+namespace scan {
+/* 每一位变成它以及它之前所有位的异或：两个引号之间（包括左引号）的位都是 1 */
+inline uint64_t prefix_xor(uint64_t x) {
+  x ^= x << 1;
+  x ^= x << 2;
+  x ^= x << 4;
+  x ^= x << 8;
+  x ^= x << 16;
+  x ^= x << 32;
+  return x;
+}
+} // namespace scan
+
+/**
+ * 第一步：找出顶层数组每个元素对应的那一段（前后可能有空白），不做校验，
+ * 元素里的错误留给第二步的 Parser 去发现。
+ * 每 64 字节一块：先去掉被 \ 转义的引号，再用 prefix_xor 得到哪些字节在字符串里，
+ * 字符串外面的结构字符才改变深度，深度为 1 的逗号就是元素的分界。
+ * @param content
+ * @param elements
+ * @return false 表示不能这样切（不是数组、有注释、括号不配对），应该退回单线程解析
+ */
+inline bool ParallelParser::split(string_view content,
+                                  std::vector<string_view> &elements) const {
+  const char *data = content.data();
+  size_t size = content.size(), begin = 0;
+  while (begin < size &&
+         (scan::char_table.cls[(uint8_t)data[begin]] & scan::C_WS))
+    begin++;
+  if (begin == size || data[begin] != '[')
+    return false;
+
+  size_t depth = 0, start = begin + 1;
+  bool escape_carry = false; /* 上一块最后一个字符是没有被抵消的 \ */
+  uint64_t string_carry = 0; /* 上一块结束时还在字符串里，全 1 或者全 0 */
+  for (size_t off = begin & ~size_t(63); off < size; off += 64) {
+    const char *p = data + off;
+    char tail[64]{};
+    if (off + 64 > size) { /*最后不足 64 字节的块补 0，避免越界读*/
+      std::memcpy(tail, p, size - off);
+      p = tail;
+    }
+    BlockMasks masks = scan::classify(p);
+    /*被转义的字符：\ 一般很少，逐个处理就够了*/
+    uint64_t escaped = 0, backslash = masks.backslash;
+    if (escape_carry) {
+      escaped = 1;
+      backslash &= ~uint64_t(1);
+      escape_carry = false;
+    }
+    while (backslash) {
+      int i = scan::ctz(backslash);
+      backslash &= backslash - 1;
+      if (i == 63) {
+        escape_carry = true;
+      } else {
+        escaped |= uint64_t(1) << (i + 1);
+        backslash &= ~(uint64_t(1) << (i + 1));
+      }
+    }
+    uint64_t in_string =
+        scan::prefix_xor(masks.quote & ~escaped) ^ string_carry;
+    string_carry = uint64_t(0) - (in_string >> 63);
+
+    /*字符串外面的 / 只能是注释，交给单线程的 Parser 处理*/
+    if (std::memchr(p, '/', 64) != nullptr) {
+      for (int i = 0; i < 64; i++)
+        if (p[i] == '/' && !(in_string >> i & 1))
+          return false;
+    }
+    uint64_t structural = masks.structural & ~in_string;
+    if (off < begin) /*第一块里 [ 之前的部分不算*/
+      structural &= ~uint64_t(0) << (begin - off);
+    while (structural) {
+      size_t pos = off + scan::ctz(structural);
+      structural &= structural - 1;
+      switch (data[pos]) {
+      case '[':
+      case '{':
+        depth++;
+        break;
+      case ']':
+      case '}':
+        if (depth == 0)
+          return false;
+        if (--depth == 0) { /*顶层数组结束，后面的内容和 Parser 一样不管*/
+          if (data[pos] != ']')
+            return false;
+          /*只有空白说明是空数组，或者末尾多了一个逗号；
+           * 后者在严格模式下退回单线程解析，由 Parser 报错*/
+          string_view last = trim_right(data + start, pos - start);
+          if (!last.empty())
+            elements.push_back(last);
+          else if (!elements.empty() && m_options.syntax != SYNTAX_JSONC)
+            return false;
+          return true;
+        }
+        break;
+      case ',':
+        if (depth == 1) {
+          /*两个逗号之间是空的也放进去，让 Parser 报错*/
+          elements.push_back(trim_right(data + start, pos - start));
+          start = pos + 1;
+        }
+        break;
+      default:
+        break;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * 解析整个文档
+ * @param content 解析期间必须一直有效，borrow 时要比返回的 JObject 活得久
+ * @return 和 Parser::FromString 的结果一样
+ */
+inline JObject ParallelParser::Parse(string_view content) {
+  m_elements = 0;
+  bool counted = Instrument::Enabled();
+  double start = counted ? Instrument::Now() : 0;
+  unsigned threads = thread_count();
+  std::vector<string_view> elements;
+  if (threads <= 1 || content.size() < m_options.min_parallel_bytes ||
+      !split(content, elements))
+    return parse_sequential(content);
+
+  JObject root(T_LIST, nullptr);
+  list_t &list = root.Value<list_t>();
+  list.resize(elements.size());
+  /*每个任务是连续的一段元素，任务比线程多一些，元素大小不均匀时也能分得比较平均*/
+  size_t tasks = std::min(elements.size(), size_t(threads) * 8);
+  threads = unsigned(std::min(size_t(threads), tasks));
+  std::atomic<size_t> next{0};
+  /*出错的元素里下标最小的那个。任务是按顺序领的，某个元素出错之后，
+   * 它前面的元素都已经被领走了，领到的线程会把它们解析完，
+   * 这样抛出的一定是第一个坏元素的异常，和单线程解析一样；它后面的就不用解析了*/
+  std::atomic<size_t> error_index{elements.size()};
+  std::exception_ptr error;
+  std::mutex mutex;
+  Stats stats; /*打开了统计时，所有线程的结果合并到这里*/
+  auto work = [&](Parser &parser) {
+    for (;;) {
+      size_t task = next.fetch_add(1);
+      if (task >= tasks)
+        return;
+      size_t first = elements.size() * task / tasks;
+      size_t last = elements.size() * (task + 1) / tasks;
+      for (size_t i = first; i < last; i++) {
+        if (i >= error_index.load(std::memory_order_relaxed))
+          return; /*后面领到的任务下标只会更大*/
+        try {
+          parser.init(elements[i], m_options.borrow);
+          list[i] = parser.parse();
+          /*元素后面到逗号之间只能是空白*/
+          if (parser.pos() < elements[i].size())
+            throw std::logic_error("expected ',' in parse list");
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (i < error_index.load(std::memory_order_relaxed)) {
+            error_index.store(i, std::memory_order_relaxed);
+            error = std::current_exception();
+          }
+          return;
+        }
+      }
+    }
+  };
+  auto worker = [&] {
+    Parser parser;
+    parser.set_syntax(m_options.syntax);
+    Stats local;
+    if (counted)
+      parser.collect_stats(&local);
+    work(parser);
+    if (counted) {
+      std::lock_guard<std::mutex> lock(mutex);
+      stats.Add(local);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned t = 1; t < threads; t++)
+    workers.emplace_back(worker);
+  worker(); /*当前线程也干活*/
+  for (auto &thread : workers)
+    thread.join();
+  if (error)
+    std::rethrow_exception(error);
+  m_elements = elements.size();
+  if (counted) { /*加上顶层的数组，每个元素都在它里面一层*/
+    stats.parses = 1;
+    stats.bytes_in = content.size();
+    stats.nodes[T_LIST]++;
+    stats.max_depth++;
+    stats.bytes_allocated += sizeof(list_t) + list.capacity() * sizeof(JObject);
+    stats.parse_seconds = Instrument::Now() - start;
+    Instrument::Record(stats);
+  }
+  return root;
+}
+} // namespace json
+
+#endif // MYJSON_PARSER_PARALLELPARSER_H
@@ -1,9 +1,19 @@
 #ifndef MYJSON_PARSER_PARSER_H
 #define MYJSON_PARSER_PARSER_H
 
+#include "Handler.h"
 #include "JObject.h"
+#include "Escape.h"
+#include "MappedFile.h"
+#include "Number.h"
+#include "Reflect.h"
+#include "Scanner.h"
+#include "Stats.h"
 #include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -57,7 +67,7 @@ using std::string_view;
 using std::stringstream;
 /*对应json的类型*/
 using null_t = string;
-using int_t = int32_t;
+using int_t = int64_t;
 using bool_t = bool;
 using double_t = double;
 using str_t = string;
@@ -72,27 +82,85 @@ class JObject;
 class Parser {
 public:
   Parser() = default;
-  static JObject FromString(string_view content);
+  /** @funtional syntax 为 SYNTAX_JSONC 时接受末尾多一个逗号（见 JObject.h），
+   * 下面的 FromStringView、FromFile、FromFileView 和事件模式也一样 */
+  static JObject FromString(string_view content,
+                            SYNTAX syntax = SYNTAX_STRICT);
+  /** @funtional 零拷贝解析：不含转义的字符串值直接指向 content，
+   * 调用者必须保证 content（比如 mmap 的文件）活得比返回的 JObject 久 */
+  static JObject FromStringView(string_view content,
+                                SYNTAX syntax = SYNTAX_STRICT);
+  /** @funtional 和 FromString 一样，但是 key 和短的字符串值都借用 table 里的那一份
+   * （见 Intern.h），table 可以反复用来解析同一种格式的文档，但必须比返回的 JObject 活得久 */
+  static JObject FromString(string_view content, InternTable &table,
+                            SYNTAX syntax = SYNTAX_STRICT);
+  /** @funtional 解析文件：mmap 之后直接在映射的页面上解析，不先读进 string，
+   * 字符串值都拷贝出来，返回之前就解除映射 */
+  static JObject FromFile(std::string const &path,
+                          SYNTAX syntax = SYNTAX_STRICT);
+  /** @funtional 零拷贝地解析文件：字符串值直接指向映射的页面，
+   * 返回的 shared_ptr 同时持有映射，最后一个指向它（或者它的子节点，
+   * 用 shared_ptr 的别名构造）的 shared_ptr 析构时才解除映射 */
+  static std::shared_ptr<JObject>
+  FromFileView(std::string const &path, SYNTAX syntax = SYNTAX_STRICT);
+  /** @funtional 事件（SAX）模式：不构建 JObject 树，每解析出一个 token
+   * 就调用一次 handler 的方法，接口见 Handler.h */
+  template <class Handler>
+  static void FromString(string_view content, Handler &handler,
+                         SYNTAX syntax = SYNTAX_STRICT);
   /** @funtional 对任意类型进行 序列化(C++ struct => json字符串) */
   template <class T> static string ToJSON(T const &src);
   /** @funtional 对任意类型进行 反序列化(json字符串 => C++ struct ) */
   template <class T> static T FromJson(string_view src);
-  void init(string_view src);
+  void init(string_view src, bool borrow = false,
+            std::pmr::memory_resource *arena = nullptr,
+            InternTable *intern = nullptr);
+  /* 和 init 无关，设置一次之后解析的所有文档都有效 */
+  void set_syntax(SYNTAX syntax) { m_trailing_commas = syntax == SYNTAX_JSONC; }
+  /* 不为空时，打开了统计的 parse() 把结果累加到 into 里，不再各自记一次
+   * （ParallelParser、NdJsonReader 的工作线程用，最后在调用线程记成一次） */
+  void collect_stats(Stats *into) { m_collect = into; }
   void trim_right();
   void skip_comment();
+  char next_after_comma(char close);
   bool is_esc_consume(size_t pos);
+  char char_at(size_t pos) const;
   char get_next_token();
   JObject parse();
-  JObject parse_null();
-  JObject parse_number();
+  template <class Handler> void parse_value(Handler &handler);
+  template <class Handler> void parse_counted(Handler &handler, Stats &stats);
+  void parse_null();
+  num::Number parse_number();
   bool parse_bool();
-  string parse_string();
-  JObject parse_list();
-  JObject parse_dict();
+  string_view parse_string();
+  size_t skip_string(bool &escaped);
+  string_view unescape(string_view raw);
+  void skip_value();
+  /* 按需解析（见 Lazy.h）时在输入里来回跳转用 */
+  size_t pos() const { return m_idx; }
+  void seek(size_t pos) { m_idx = pos; }
+  template <class Handler> void parse_list(Handler &handler);
+  template <class Handler> void parse_dict(Handler &handler);
 
 private:
-  string m_str;
-  size_t m_idx{}; /*当前解析的字符的位置 0 */
+  /*只是观察调用者的缓冲区，不再拷贝一份输入*/
+  string_view m_str;
+  size_t m_idx{};       /*当前解析的字符的位置 0 */
+  bool m_borrow{false}; /*为 true 时字符串值借用 m_str，不拷贝*/
+  /*不为空时，所有的容器、key和字符串都从这里分配（见 Document）*/
+  std::pmr::memory_resource *m_arena{nullptr};
+  /*不为空时，key 和短的字符串值都放进这个表里（见 Intern.h）*/
+  InternTable *m_intern{nullptr};
+  /*SIMD 分类出的空白、引号位图，用来跳过空白和查找字符串结尾*/
+  Scanner m_scanner;
+  /*含有转义的字符串解码到这里，下一个字符串会覆盖它*/
+  std::string m_unescaped;
+  /*为 true 时接受 list/dict 末尾多一个逗号（SYNTAX_JSONC）*/
+  bool m_trailing_commas{false};
+  /*打开了统计时不为空，记录跳过的注释（见 Stats.h）*/
+  Stats *m_stats{nullptr};
+  /*不为空时解析的结果累加到这里，不交给 Instrument（见 collect_stats）*/
+  Stats *m_collect{nullptr};
 };
 /*
  ======================================================================
@@ -102,60 +170,153 @@ private:
 
 /**
  * 反序列化
- * 这里创建一个静态的 Parser实例，将上面提到的三步操作封装为一步
- *  虽然这里不是单例模式，但是复用这一个 instance 就够了。
+ * 这里创建一个 Parser实例，将上面提到的三步操作封装为一步
+ *  每个线程复用自己的 instance（thread_local），多个线程同时调用互不干扰，
+ *  不需要在外面加锁；解析结果里不保存任何指向 instance 的东西。
  * @param content
  * @return
  */
-JObject Parser::FromString(string_view content) {
-  static Parser instance;
+JObject Parser::FromString(string_view content, SYNTAX syntax) {
+  thread_local Parser instance;
   instance.init(content);
+  instance.set_syntax(syntax);
   return instance.parse();
 }
 
+/**
+ * 零拷贝的反序列化，和 FromString 唯一的区别是字符串值不拷贝，
+ * 而是以 string_view 的形式指向 content。
+ * @param content 调用者持有的缓冲区
+ * @return
+ */
+JObject Parser::FromStringView(string_view content, SYNTAX syntax) {
+  thread_local Parser instance;
+  instance.init(content, true);
+  instance.set_syntax(syntax);
+  return instance.parse();
+}
+
+/**
+ * 用 intern 表的反序列化，重复的 key（以及短的字符串值）只保存一份
+ * @param content
+ * @param table
+ * @return
+ */
+JObject Parser::FromString(string_view content, InternTable &table,
+                           SYNTAX syntax) {
+  thread_local Parser instance;
+  instance.init(content, false, nullptr, &table);
+  instance.set_syntax(syntax);
+  return instance.parse();
+}
+
+/**
+ * 解析文件，映射只在解析期间存在
+ * @param path
+ * @return
+ */
+JObject Parser::FromFile(std::string const &path, SYNTAX syntax) {
+  MappedFile file(path);
+  return FromString(file.view(), syntax);
+}
+
+/**
+ * 零拷贝地解析文件：映射和解析结果放在同一个控制块里，
+ * 返回指向结果的别名 shared_ptr，所以结果活着映射就一直在。
+ * 成员的析构顺序和声明相反，先析构 root 再解除映射
+ * @param path
+ * @return
+ */
+std::shared_ptr<JObject> Parser::FromFileView(std::string const &path,
+                                              SYNTAX syntax) {
+  struct Mapped {
+    MappedFile file;
+    JObject root;
+  };
+  auto mapped = std::make_shared<Mapped>();
+  mapped->file.open(path);
+  mapped->root = FromStringView(mapped->file.view(), syntax);
+  return std::shared_ptr<JObject>(mapped, &mapped->root);
+}
+
+/**
+ * 事件模式的解析，整个过程只占用 O(深度) 的内存
+ * @param content
+ * @param handler
+ */
+template <class Handler>
+void Parser::FromString(string_view content, Handler &handler,
+                        SYNTAX syntax) {
+  Parser parser;
+  parser.init(content);
+  parser.set_syntax(syntax);
+  if (Instrument::Enabled()) [[unlikely]] {
+    Stats stats;
+    parser.parse_counted(handler, stats);
+    return;
+  }
+  parser.parse_value(handler);
+}
+
 /**
  * 为什么用 string_view，因为直接用string会经常发生拷贝，导致性能下降。
- * 为什么不用 string_view 仅仅有观察权，没有资源所有权。
+ * string_view 仅仅有观察权，没有资源所有权，所以解析期间 src 必须一直有效。
  * @param src 需要解析的字符串
+ * @param borrow 解析出的字符串值是否直接借用 src
+ * @param arena 解析结果的内存从哪里分配，为空则用默认的堆
+ * @param intern 不为空时 key 和短的字符串值都从这个表里借用
  */
-void Parser::init(std::string_view src) {
-  /* 当前需要解析的字符串，这里赋值实际上调用了一次 拷贝构造函数，而不是
-   * 赋值构造函数 */
+void Parser::init(std::string_view src, bool borrow,
+                  std::pmr::memory_resource *arena, InternTable *intern) {
+  /* 当前需要解析的字符串，只是记录视图，不再拷贝整个文档 */
   m_str = src;
   m_idx = 0; /* 当前已经解析到的字符的位置 下标 */
+  m_borrow = borrow;
+  m_arena = arena;
+  m_intern = intern;
   /* 去末尾除多余空格，FIXME: 防止末尾多余的空格对解析过程产生错误 */
   trim_right();
+  m_scanner.init(m_str);
 }
 
 /**
  * 去除尾部空字符，方便最后的结束判断
  */
 void Parser::trim_right() {
-  /* 使用一个 反向迭代器 和 find_if
-   * 结合，从字符串末尾开始，直到找到第一个不是空格的字符的位置，
-   * 然后使用 erase 函数删除这些空格*/
-  m_str.erase(std::find_if(m_str.rbegin(), m_str.rend(),
-                           [](char ch) { return !std::isspace(ch); })
-                  .base(),
-              m_str.end());
+  /* 从末尾开始找到第一个不是空格的字符，然后把视图的尾巴缩短，
+   * 不需要像 erase 那样修改（甚至拷贝）原字符串 */
+  while (!m_str.empty() && std::isspace((unsigned char)m_str.back()))
+    m_str.remove_suffix(1);
 }
+
+/**
+ * string_view 不保证以 '\0' 结尾，越界的位置统一当作 '\0'，
+ * 这样原来依赖 string 结尾 '\0' 的判断逻辑不需要改变。
+ * @param pos
+ * @return
+ */
+char Parser::char_at(size_t pos) const {
+  return pos < m_str.size() ? m_str[pos] : '\0';
+}
+
 /**
  * 跳过vscode的 // 开头的注释
  */
 void Parser::skip_comment() {
-  if (m_str.compare(m_idx, 2, R"(//)") == 0) {
+  /*绝大多数 token 都不是 / 开头的，先比较一个字符*/
+  if (char_at(m_idx) == '/' && m_str.compare(m_idx, 2, R"(//)") == 0) {
     while (true) {
       /*找换行符*/
       auto next_pos = m_str.find('\n', m_idx);
       if (next_pos == string::npos) {
         throw std::logic_error("invalid comment area!");
       }
+      if (m_stats) [[unlikely]]
+        m_stats->comments++;
       /*查看下一行是否还是注释*/
       m_idx = next_pos + 1;
       /*先跳过 // 之前的空格*/
-      while (isspace(m_str[m_idx])) {
-        m_idx++;
-      }
+      m_idx = m_scanner.skip_whitespace(m_idx);
       /*这是找不到注释的就跳出循环*/
       if (m_str.compare(m_idx, 2, R"(//)") != 0) { // 结束注释
         return;
@@ -170,17 +331,32 @@ void Parser::skip_comment() {
  * @return
  */
 char Parser::get_next_token() {
-  /* 这个 while 的功能就是跳过token之间的空白字符
-   * 是跳过，而不是删除这些空格，因为这里的操作是让 目前处理的字符位置++*/
-  while (std::isspace(m_str[m_idx]))
-    m_idx++;
+  /* 跳过token之间的空白字符，是跳过，而不是删除这些空格。
+   * 不再逐个字节 isspace，而是按 Scanner 的空白位图一次跳过一整段；
+   * token 之间经常没有空白，这种情况查一次表就够了 */
+  if (scan::char_table.cls[(uint8_t)char_at(m_idx)] & scan::C_WS)
+    m_idx = m_scanner.skip_whitespace(m_idx);
   /* 如果当前处理的字符位置 >= 字符串的大小了，那么直接抛出异常 */
   if (m_idx >= m_str.size())
     throw std::logic_error("unexpected character in parse json");
   /*如果是注释，记得跳过*/
   skip_comment();
-  /* 返回当前解析到的token的字符 */
-  return m_str[m_idx];
+  /* 返回当前解析到的token的字符（注释可能一直到文件末尾） */
+  return char_at(m_idx);
+}
+
+/**
+ * m_idx 指向 list/dict 里的逗号：跳过它，返回下一个 token。
+ * 下一个 token 就是 close 的话说明末尾多了一个逗号，只有 SYNTAX_JSONC 才接受
+ * @param close ] 或者 }
+ * @return
+ */
+char Parser::next_after_comma(char close) {
+  m_idx++;
+  char ch = get_next_token();
+  if (ch == close && !m_trailing_commas)
+    throw std::logic_error("trailing comma in parse json");
+  return ch;
 }
 
 bool Parser::is_esc_consume(size_t pos) {
@@ -193,33 +369,87 @@ bool Parser::is_esc_consume(size_t pos) {
 }
 
 /**
- * 解析的核心函数
+ * 解析成 JObject 树：DOM 也只是事件的一种用法，
+ * 由 DomBuilder 接收 parse_value 发出的事件来构建
  * @return 返回一个JObject
  */
 JObject Parser::parse() {
+  DomBuilder builder(m_arena, m_borrow ? m_str : string_view{}, m_intern);
+  if (Instrument::Enabled()) [[unlikely]] {
+    Stats stats;
+    builder.set_stats(&stats);
+    parse_counted(builder, stats);
+  } else {
+    parse_value(builder);
+  }
+  return std::move(builder.result());
+}
+
+/**
+ * 打开了统计时的解析：用 StatsHandler 包住 handler 数节点，
+ * 结束之后记下消耗的字节数和耗时。解析失败时不记录
+ * @param handler
+ * @param stats 这一次调用的结果
+ */
+template <class Handler>
+void Parser::parse_counted(Handler &handler, Stats &stats) {
+  StatsHandler<Handler> counter(handler, stats);
+  m_stats = &stats;
+  double start = Instrument::Now();
+  try {
+    parse_value(counter);
+  } catch (...) {
+    m_stats = nullptr;
+    throw;
+  }
+  m_stats = nullptr;
+  stats.parse_seconds = Instrument::Now() - start;
+  stats.parses = 1;
+  stats.bytes_in = m_idx;
+  if (m_collect)
+    m_collect->Add(stats);
+  else
+    Instrument::Record(stats);
+}
+
+/**
+ * 解析的核心函数，解析一个值，把它变成事件交给 handler
+ * @param handler
+ */
+template <class Handler> void Parser::parse_value(Handler &handler) {
   /*跳过空白符号，以及跳过注释(只有vscode版的json才有注释，其余的都没有的)*/
   char token = get_next_token();
-  if (token == 'n') {    /* 如果解析到的是n，那么则是 null */
-    return parse_null(); /* 返回的是一个 JObject */
+  if (token == 'n') { /* 如果解析到的是n，那么则是 null */
+    parse_null();
+    handler.null();
+    return;
   }
   if (token == 't' || token == 'f') { /*bool类型的就是 true 或者 false */
-    return parse_bool(); /* FIXME: 这里发生了bool类型，隐式转换成了 JObject
-                    类型*/
+    handler.boolean(parse_bool());
+    return;
   }
   if (token == '-' ||
       std::isdigit(
           token)) { /*如果是 `-` 负号，或者数字。那么token就是一个数字*/
-    return parse_number(); /*FIXME： 这里需要注意double类型的转换*/
+    num::Number number = parse_number();
+    if (number.is_int)
+      handler.integer(number.i);
+    else
+      handler.number(number.d);
+    return;
   }
   if (token ==
       '\"') { /*这里需要用转义字符 \ ，如果数据带引号，那么就是字符串类型*/
-    return parse_string();
+    handler.str(parse_string());
+    return;
   }
   if (token == '[') { /*list的开头*/
-    return parse_list();
+    parse_list(handler);
+    return;
   }
   if (token == '{') { /*map的开头*/
-    return parse_dict();
+    parse_dict(handler);
+    return;
   }
   /*如果上面的规则，一个都没匹配上，那么说明这个字符不是我们预期的，抛出异常*/
   throw std::logic_error("unexpected character in parse json");
@@ -227,57 +457,29 @@ JObject Parser::parse() {
 /**
  * 假如token是null，那么当时返回的token的首字母是 n 。
  * 往后找到4个字符，再和 "null" 比较，如果相等，则token正确
- *      当前处理的字符位置+4 ，返回的对象是一个空对象
- * @return 空对象null
+ *      当前处理的字符位置+4
  */
-JObject Parser::parse_null() {
+void Parser::parse_null() {
   if (m_str.compare(m_idx, 4, "null") == 0) {
     m_idx += 4;
-    return {}; /*创建一个空的初始化列表，发生从 void*到 JObject的隐式转换*/
+    return;
   }
   /*如果n开头的token，却不是null的话，说明发生了解析错误（json本身就不对）*/
   throw std::logic_error("parse null error");
 }
 /**
- * 解析数字，包括负数
- * @return
+ * 解析数字，包括负数、小数和指数（1e10），整数支持到 64 位。
+ * 数字只扫描一遍，不再交给 strtol/strtod 重新扫描（它们和 locale 有关，
+ * 而且 m_str 末尾不一定有 '\0'），具体见 Number.h
+ * @return 整数或者 double
  */
-JObject Parser::parse_number() {
-  size_t pos = m_idx;
-  /*整数部分*/
-  if (m_str[m_idx] == '-') {
-    m_idx++; /*处理负号*/
-  }
-  /*遍历完数据的整数部分*/
-  if (isdigit(m_str[m_idx]))
-    while (isdigit(m_str[m_idx]))
-      m_idx++;
-  else {
-    throw std::logic_error("invalid character in number");
-  }
-  /* 如果不存在小数点，那么直接返回以上解析出的数字了！*/
-  if (m_str[m_idx] != '.') {
-    /*strtol的作用是将字符串转换为 long 类型， endptr
-     * 指向第一个不可转换的字符位置的指针，base10 表示转换成10进制数*/
-    return (int)strtol(m_str.c_str() + pos, nullptr, 10);
-  }
-
-  // 处理小数部分
-  if (m_str[m_idx] == '.') {
-    m_idx++; /*跳过小数点*/
-    if (!std::isdigit(m_str[m_idx])) {
-      /*如果小数点后没有数字，那么报错*/
-      throw std::logic_error(
-          "at least one digit required in parse float part!");
-    }
-    /*处理小数点之后的数字*/
-    while (std::isdigit(m_str[m_idx]))
-      m_idx++;
-  }
-  /*使用strtod将字符串转换为 double 类型的数据*/
-  return strtod(
-      m_str.c_str() + pos,
-      nullptr); /* 没有遇到不能被转换的字符，那么endptr会被设置为 nullptr */
+num::Number Parser::parse_number() {
+  const char *begin = m_str.data() + m_idx;
+  num::Number number{};
+  const char *end =
+      num::parse_number(begin, m_str.data() + m_str.size(), number);
+  m_idx += end - begin;
+  return number;
 }
 /**
  * 将字符 true或者false解析为 true或者false
@@ -296,10 +498,32 @@ bool Parser::parse_bool() {
   throw std::logic_error("parse bool error");
 }
 
-string Parser::parse_string() {
-  auto pre_pos = ++m_idx; /*字符串起始位置*/
-                          /*找到下一个 " （字符串结束标志）*/
-  auto pos = m_str.find('"', m_idx);
+/**
+ * 解析字符串。没有转义时返回的是 m_str 中 "..." 之间内容的视图，不发生拷贝，
+ * 由调用者决定是拷贝还是直接借用；有转义时返回解码之后的 m_unescaped，
+ * 只在解析下一个字符串之前有效。
+ * @return
+ */
+string_view Parser::parse_string() {
+  auto pre_pos = m_idx + 1; /*字符串起始位置*/
+  bool escaped = false;     /*字符串里有没有 \ */
+  auto pos = skip_string(escaped);
+  /*没有 \ 的话直接返回"..."中间的视图，否则解码到 m_unescaped 里*/
+  string_view raw = m_str.substr(pre_pos, pos - pre_pos);
+  if (escaped) [[unlikely]]
+    return unescape(raw);
+  return raw;
+}
+
+/**
+ * m_idx 指向字符串开头的 "，找到真正结尾的 "，m_idx 移到它的后面
+ * @param escaped 字符串里有 \ 时置为 true
+ * @return 结尾的 " 的位置
+ */
+size_t Parser::skip_string(bool &escaped) {
+  ++m_idx;
+  /*找到下一个 " （字符串结束标志）*/
+  auto pos = m_scanner.find_quote(m_idx, escaped);
   /*FIXME：如果找到了 " 的话，还需要进一步判断，是转义的还是 真正的字符串结束*/
   if (pos != string::npos) {
     /*解析还没有结束，需要判断是否是转义的结束符号，如果是转义，则需要继续探查*/
@@ -315,35 +539,100 @@ string Parser::parse_string() {
         break;
       }
       /*从下一个位置开始，再找 " */
-      pos = m_str.find('"', pos + 1);
+      pos = m_scanner.find_quote(pos + 1);
       /*如果没找到*/
       if (pos == string::npos) {
         throw std::logic_error(R"(expected left '"' in parse string)");
       }
     }
     m_idx = pos + 1; /*跳过 左" */
-                     /*截取"..."，返回string的内容*/
-    return m_str.substr(pre_pos, pos - pre_pos);
+    return pos;
   }
   /*如果根本就没找到 " ，那么json格式是错误的 */
   throw std::logic_error("parse string error");
 }
 
-JObject Parser::parse_list() {
-  /* list_t实际上是 => vector<JObject> */
-  JObject arr(
-      (list_t())); /* 这里没有使用隐式转换，而是显示的定义了一个 JObject 类 */
-  m_idx++;         /*跳过 `[` 字符*/
+/**
+ * 字符串里有转义时才走这里：解码到 m_unescaped，返回它的视图
+ * @param raw "..." 之间的原始内容
+ * @return
+ */
+string_view Parser::unescape(string_view raw) {
+  m_unescaped.resize(raw.size());
+  return {m_unescaped.data(), esc::unescape(raw, m_unescaped.data())};
+}
+
+/**
+ * 跳过一个值，不解码也不发出事件：
+ * 字符串只找结尾的 "，list/dict 只做括号匹配（跳过其中的字符串和注释）
+ */
+void Parser::skip_value() {
+  char ch = get_next_token();
+  if (ch == '"') {
+    bool escaped = false;
+    skip_string(escaped);
+    return;
+  }
+  if (ch != '[' && ch != '{') {
+    /*数字、true/false/null：一直到空白、结构字符或者注释为止*/
+    size_t begin = m_idx;
+    while (m_idx < m_str.size() && m_str[m_idx] != '/' &&
+           !(scan::char_table.cls[(uint8_t)m_str[m_idx]] &
+             (scan::C_WS | scan::C_STRUCT | scan::C_QUOTE)))
+      m_idx++;
+    if (m_idx == begin)
+      throw std::logic_error("unexpected character in parse json");
+    return;
+  }
+  size_t depth = 0;
+  while (m_idx < m_str.size()) {
+    switch (m_str[m_idx]) {
+    case '"': {
+      bool escaped = false;
+      skip_string(escaped);
+      continue;
+    }
+    case '/':
+      if (m_str.compare(m_idx, 2, R"(//)") != 0)
+        throw std::logic_error("invalid comment area!");
+      skip_comment();
+      continue;
+    case '[':
+    case '{':
+      depth++;
+      break;
+    case ']':
+    case '}':
+      if (--depth == 0) {
+        m_idx++;
+        return;
+      }
+      break;
+    default:
+      break;
+    }
+    m_idx++;
+  }
+  throw std::logic_error("unexpected end of input in parse json");
+}
+
+/**
+ * 解析 list，发出 start_array、每个元素的事件、end_array
+ * @param handler
+ */
+template <class Handler> void Parser::parse_list(Handler &handler) {
+  handler.start_array();
+  m_idx++;                    /*跳过 `[` 字符*/
   char ch = get_next_token(); /*过滤空字符，得到下一个 token */
   if (ch == ']') { /*如果下一个字符是 `]` ，则list结束 ，直接返回*/
     m_idx++;
-    return arr;
+    handler.end_array();
+    return;
   }
   /*如果list没有结束，其中包含 那6种基础类型*/
   while (true) {
-    arr.push_back(
-        parse());          /*FIXME：这里是递归调用了
-                  parse，得到基本数据类型（也有可能是list，嵌套过多可能导致爆栈）*/
+    parse_value(handler);  /*FIXME：这里是递归调用了
+                  parse_value，得到基本数据类型（也有可能是list，嵌套过多可能导致爆栈）*/
     ch = get_next_token(); /*再获取下一个token*/
                            /*遇到 ] 说明结束了*/
     if (ch == ']') {
@@ -354,32 +643,37 @@ JObject Parser::parse_list() {
     if (ch != ',') {
       throw std::logic_error("expected ',' in parse list");
     }
-    /*如果是逗号，则 跳过逗号，下面还有字符要解析，再循环*/
-    m_idx++;
+    /*如果是逗号，则 跳过逗号，下面还有字符要解析，再循环；
+     * 末尾多一个逗号（比如 [1, 2, ]）只有 SYNTAX_JSONC 才接受*/
+    if (next_after_comma(']') == ']') {
+      m_idx++;
+      break;
+    }
   }
   /*整个list解析完成*/
-  return arr;
+  handler.end_array();
 }
 /**
- * dict_t => map<string, JObject>;
- * @return
+ * 解析 dict，发出 start_object、每一对 key 和 value 的事件、end_object
+ * @param handler
  */
-JObject Parser::parse_dict() {
-  JObject dict((dict_t()));
+template <class Handler> void Parser::parse_dict(Handler &handler) {
+  handler.start_object();
   m_idx++; /*跳过 { */
   char ch = get_next_token();
   /*如果是 } 则结束*/
   if (ch == '}') {
     m_idx++;
-    return dict;
+    handler.end_object();
+    return;
   }
   while (true) {
-    /* 首先解析key，这里的
-     * .Value<string>方法返回的是parse得到的数据（默认map的key是string类型的）
-     */
-    /*因为parse().Value()得到的值是匿名对象，返回之后就是死掉了。
-将返回的字符串的值转移给key，防止拷贝，原来字符串的值可能变成空或者其他不确定的值*/
-    string key = std::move(parse().Value<string>());
+    /* 首先解析key，json的key只能是字符串，所以直接调用 parse_string */
+    ch = get_next_token();
+    if (ch != '"') {
+      throw std::logic_error("expected string key in parse dict");
+    }
+    handler.key(parse_string());
     ch = get_next_token();
     /*如果不是 冒号，那么不符合 json 规则了。*/
     if (ch != ':') {
@@ -388,7 +682,7 @@ JObject Parser::parse_dict() {
     m_idx++; /*跳过冒号*/
 
     /*解析value*/
-    dict[key] = parse(); /*FIXME：这里dict重载了下标运算符，可以直接 = 运算*/
+    parse_value(handler);
     ch = get_next_token();
     /*如果到 }，则结束了*/
     if (ch == '}') {
@@ -399,29 +693,41 @@ JObject Parser::parse_dict() {
     if (ch != ',') {
       throw std::logic_error("expected ',' in parse dict");
     }
-    /*跳过逗号*/
-    m_idx++;
+    /*跳过逗号，末尾多一个逗号（比如 {"a": 1, }）只有 SYNTAX_JSONC 才接受*/
+    if (next_after_comma('}') == '}') {
+      m_idx++;
+      break;
+    }
     /*继续循环*/
   }
-  return dict;
+  handler.end_object();
 }
 template <class T> T Parser::FromJson(string_view src) {
-  JObject object = FromString(src);
-  // 如果是基本类型
-  if constexpr (is_basic_type<T>()) {
-    return object.template Value<T>();
-  }
+  if constexpr (reflect::Reflectable<T>) {
+    /*用 json_fields 描述过的类型直接从 token 流填充，不构建 JObject（见 Reflect.h）*/
+    Parser parser;
+    parser.init(src);
+    T ret{};
+    reflect::read(parser, ret);
+    return ret;
+  } else {
+    JObject object = FromString(src);
+    // 如果是基本类型
+    if constexpr (is_basic_type<T>()) {
+      return object.template Value<T>();
+    }
 
-  // 调用T类型对应的成岩函数
-  if (object.Type() != T_DICT)
-    throw std::logic_error("not dict type fromjson");
-  T ret;
-  ret.FUNC_FROM_NAME(object);
-  return ret;
+    // 调用T类型对应的成岩函数
+    if (object.Type() != T_DICT)
+      throw std::logic_error("not dict type fromjson");
+    T ret;
+    ret.FUNC_FROM_NAME(object);
+    return ret;
+  }
 }
 template <class T> string Parser::ToJSON(const T &src) {
   /*如果是基本类型(非dict)，先封装成JObject，才能调用其 ToString的方法*/
-  if constexpr (IS_TYPE(T, int_t)) {
+  if constexpr (std::is_integral_v<T> && !IS_TYPE(T, bool_t)) {
     JObject object(src);
     return object.ToString();
   } else if constexpr (IS_TYPE(T, bool_t)) {
@@ -433,15 +739,21 @@ template <class T> string Parser::ToJSON(const T &src) {
   } else if constexpr (IS_TYPE(T, str_t)) {
     JObject object(src);
     return object.ToString();
+  } else if constexpr (reflect::Reflectable<T>) {
+    /*用 json_fields 描述过的类型直接写成 JSON 文本，不经过 JObject（见 Reflect.h）*/
+    string out;
+    reflect::write(out, src);
+    return out;
+  } else {
+    /*如果是自定义类型调用方法完成dict的赋值，然后ToString即可
+     * （自定义类型肯定是 dict 类型）*/
+    json::JObject obj((json::dict_t())); /*创建一个空dict*/
+    /*需要你对该类型定义对应的方法，该方法需要将值传递给
+     * JObject，为了简化这个过程我们用宏来替代。
+     * FUNC_TO_NAME是通过宏，自动生成(🤣循环嵌套，这里有点令人费解) 对应方法 的*/
+    src.FUNC_TO_NAME(obj);
+    return obj.ToString();
   }
-  /*如果是自定义类型调用方法完成dict的赋值，然后ToString即可
-   * （自定义类型肯定是 dict 类型）*/
-  json::JObject obj((json::dict_t())); /*创建一个空dict*/
-  /*需要你对该类型定义对应的方法，该方法需要将值传递给
-   * JObject，为了简化这个过程我们用宏来替代。
-   * FUNC_TO_NAME是通过宏，自动生成(🤣循环嵌套，这里有点令人费解) 对应方法 的*/
-  src.FUNC_TO_NAME(obj);
-  return obj.ToString();
 }
 } // namespace json
 
@@ -0,0 +1,132 @@
+#ifndef MYJSON_PARSER_POINTER_H
+#define MYJSON_PARSER_POINTER_H
+
+#include "JObject.h"
+#include "Lazy.h"
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace json {
+/*
+ ======================================================================
+ |                         Pointer 类定义开始                          |
+ ======================================================================
+ */
+/**
+ * 预先编译好的 JSON Pointer（RFC 6901），比如 "/[css]/editor.suggest.insertMode"、"/items/0/id"。
+ * 构造时就把路径拆成一段一段的 key，算好每个 key 的 hash 和它作为下标的值，
+ * 之后每次查找都不用再构造临时的 string、也不用重新 hash。
+ * Find 只查找不插入，找不到时返回空，被查找的对象不会被修改。
+ */
+class Pointer {
+public:
+  explicit Pointer(string_view path);
+
+  JObject *Find(JObject &root) const;
+  JObject const *Find(JObject const &root) const;
+  /* 直接在原始的 JSON 文本上查找（见 Lazy.h），不构建 JObject */
+  std::optional<LazyValue> Find(LazyValue root) const;
+
+private:
+  static constexpr size_t npos = string_view::npos;
+  /* 两个 Find 共用，Node 是 JObject 或者 const JObject */
+  template <class Node> Node *find(Node &root) const;
+  struct Token {
+    std::string key; /* ~0 ~1 已经还原成 ~ / */
+    size_t hash;
+    size_t index; /* key 是合法的下标时就是它的值，否则是 npos */
+  };
+  std::vector<Token> m_tokens;
+};
+/*
+ ======================================================================
+ |                         Pointer 类定义结束                          |
+ ======================================================================
+ */
+
+/**
+ * 解析 JSON Pointer，"" 表示根节点本身
+ * @param path 必须以 / 开头，key 里的 ~ 和 / 分别写成 ~0 和 ~1
+ */
+inline Pointer::Pointer(string_view path) {
+  if (path.empty())
+    return;
+  if (path[0] != '/')
+    throw std::logic_error("JSON pointer must start with '/'");
+  size_t begin = 1;
+  while (true) {
+    size_t end = path.find('/', begin);
+    string_view raw = path.substr(begin, end - begin);
+    Token token{{}, 0, npos};
+    for (size_t i = 0; i < raw.size(); i++) {
+      if (raw[i] != '~') {
+        token.key.push_back(raw[i]);
+      } else if (i + 1 < raw.size() && (raw[i + 1] == '0' || raw[i + 1] == '1')) {
+        token.key.push_back(raw[++i] == '0' ? '~' : '/');
+      } else {
+        throw std::logic_error("invalid escape in JSON pointer");
+      }
+    }
+    token.hash = hashed_key(token.key).hash;
+    /* 下标不能有前导 0，"0" 本身除外 */
+    if (!token.key.empty() && token.key.size() < 20 &&
+        (token.key[0] != '0' || token.key.size() == 1) &&
+        token.key.find_first_not_of("0123456789") == std::string::npos)
+      token.index = std::stoull(token.key);
+    m_tokens.push_back(std::move(token));
+    if (end == npos)
+      break;
+    begin = end + 1;
+  }
+}
+
+/**
+ * @param root
+ * @return 路径上任何一段找不到（或者类型对不上）时返回 nullptr
+ */
+template <class Node> Node *Pointer::find(Node &root) const {
+  Node *node = &root;
+  for (auto &token : m_tokens) {
+    if (node->Type() == T_DICT) {
+      auto &dict = node->template Value<dict_t>();
+      auto it = dict.find(hashed_key(token.key, token.hash));
+      if (it == dict.end())
+        return nullptr;
+      node = &it->second;
+    } else if (node->Type() == T_LIST && token.index != npos) {
+      auto &list = node->template Value<list_t>();
+      if (token.index >= list.size())
+        return nullptr;
+      node = &list[token.index];
+    } else {
+      return nullptr;
+    }
+  }
+  return node;
+}
+
+inline JObject *Pointer::Find(JObject &root) const { return find(root); }
+
+inline JObject const *Pointer::Find(JObject const &root) const {
+  return find(root);
+}
+
+inline std::optional<LazyValue> Pointer::Find(LazyValue root) const {
+  std::optional<LazyValue> node = root;
+  for (auto &token : m_tokens) {
+    /* 不是 dict 时 Find(key) 只看了第一个字符，再按下标找一次 */
+    std::optional<LazyValue> next = node->Find(string_view(token.key));
+    if (!next && token.index != npos)
+      next = node->Find(token.index);
+    if (!next)
+      return std::nullopt;
+    node = next;
+  }
+  return node;
+}
+} // namespace json
+
+#endif // MYJSON_PARSER_POINTER_H
@@ -0,0 +1,426 @@
+#ifndef MYJSON_PARSER_REFLECT_H
+#define MYJSON_PARSER_REFLECT_H
+
+#include "Escape.h"
+#include "Handler.h"
+#include "JObject.h"
+#include "Number.h"
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ranges>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace json {
+/*
+ * 不用宏的编译期反射：在 struct 里用一个 constexpr 的 json_fields 描述它的成员，
+ *
+ *   struct Base {
+ *     int pp;
+ *     string qq;
+ *     static constexpr auto json_fields =
+ *         json::fields(json::field<"pp">(&Base::pp), json::field<"qq">(&Base::qq));
+ *   };
+ *
+ * 之后 Parser::ToJSON(base) 直接把 JSON 文本写进输出缓冲区，不再先构建一个 JObject。
+ * 每个 key 在编译期就转义好了，连同两边的引号和冒号（以及前面的逗号）是一个常量字符串，
+ * 写一个 key 只需要一次 append。
+ * Parser::FromJson<Base>(text) 则直接从 token 流填充成员，同样不经过 JObject。
+ */
+
+/* 可以作为模板参数的字符串字面量 */
+template <size_t N> struct fixed_string {
+  char data[N]{};
+  constexpr fixed_string(const char (&str)[N]) {
+    for (size_t i = 0; i < N; i++)
+      data[i] = str[i];
+  }
+  constexpr std::string_view view() const { return {data, N - 1}; }
+};
+
+namespace reflect {
+/* 编译期转义一个字符，返回转义之后的长度；out 不为空时写进去 */
+constexpr size_t escape_char(char ch, char *out) {
+  constexpr char hex[] = "0123456789abcdef";
+  char short_form = 0;
+  switch (ch) {
+  case '"': short_form = '"'; break;
+  case '\\': short_form = '\\'; break;
+  case '\b': short_form = 'b'; break;
+  case '\f': short_form = 'f'; break;
+  case '\n': short_form = 'n'; break;
+  case '\r': short_form = 'r'; break;
+  case '\t': short_form = 't'; break;
+  default: break;
+  }
+  if (short_form != 0) {
+    if (out) {
+      out[0] = '\\';
+      out[1] = short_form;
+    }
+    return 2;
+  }
+  if ((unsigned char)ch < 0x20) {
+    if (out) {
+      const char buf[6] = {'\\', 'u', '0', '0', hex[(ch >> 4) & 0xF],
+                           hex[ch & 0xF]};
+      for (int i = 0; i < 6; i++)
+        out[i] = buf[i];
+    }
+    return 6;
+  }
+  if (out)
+    out[0] = ch;
+  return 1;
+}
+
+/**
+ * 编译期生成的 key：,"name":
+ * 第一个成员从 text + 1 开始写，跳过逗号
+ */
+template <fixed_string Name> struct field_key {
+  static constexpr size_t size = [] {
+    size_t n = 4; /* , " " : */
+    for (char ch : Name.view())
+      n += escape_char(ch, nullptr);
+    return n;
+  }();
+  static constexpr std::array<char, size> text = [] {
+    std::array<char, size> key{};
+    size_t n = 0;
+    key[n++] = ',';
+    key[n++] = '"';
+    for (char ch : Name.view())
+      n += escape_char(ch, key.data() + n);
+    key[n++] = '"';
+    key[n++] = ':';
+    return key;
+  }();
+};
+} // namespace reflect
+
+/* 一个成员：JSON 里的名字和成员指针 */
+template <fixed_string Name, class Class, class Member> struct Field {
+  using class_type = Class;
+  using member_type = Member;
+  static constexpr std::string_view name = Name.view();
+  /* ,"name": 转义好的常量 */
+  static constexpr std::string_view key = {
+      reflect::field_key<Name>::text.data(), reflect::field_key<Name>::size};
+  Member Class::*member;
+};
+
+/**
+ * @tparam Name JSON 里的名字
+ * @param member 成员指针，比如 &Base::pp
+ */
+template <fixed_string Name, class Class, class Member>
+constexpr Field<Name, Class, Member> field(Member Class::*member) {
+  return {member};
+}
+
+template <class... Fields> constexpr std::tuple<Fields...> fields(Fields... f) {
+  return {f...};
+}
+
+namespace reflect {
+/* 用 json_fields 描述了成员的类型 */
+template <class T>
+concept Reflectable = requires { std::tuple_size<decltype(T::json_fields)>::value; };
+
+template <class T> struct is_optional : std::false_type {};
+template <class T> struct is_optional<std::optional<T>> : std::true_type {};
+
+template <class Sink, class T> void write(Sink &out, T const &value);
+
+/* 按编译期的下标展开所有成员，第一个成员的 key 不带逗号 */
+template <class Sink, class T, size_t... I>
+void write_fields(Sink &out, T const &value, std::index_sequence<I...>) {
+  out.push_back('{');
+  (
+      [&] {
+        auto const &f = std::get<I>(T::json_fields);
+        constexpr std::string_view key =
+            std::tuple_element_t<I, std::remove_const_t<decltype(T::json_fields)>>::key;
+        if constexpr (I == 0)
+          out.append(key.data() + 1, key.size() - 1);
+        else
+          out.append(key.data(), key.size());
+        write(out, value.*(f.member));
+      }(),
+      ...);
+  out.push_back('}');
+}
+
+/**
+ * 把任意支持的类型直接写成 JSON 文本：
+ * bool、整数、浮点数、字符串、JObject、optional（空的是 null）、
+ * 用 json_fields 描述过的 struct，以及元素是这些类型的 vector/array 等容器
+ * @tparam Sink 需要有 append(const char *, size_t) 和 push_back(char)，比如 std::string
+ */
+template <class Sink, class T> void write(Sink &out, T const &value) {
+  if constexpr (IS_TYPE(T, bool_t)) {
+    if (value)
+      out.append("true", 4);
+    else
+      out.append("false", 5);
+  } else if constexpr (std::is_integral_v<T>) {
+    num::write_int(out, value);
+  } else if constexpr (std::is_floating_point_v<T>) {
+    num::write_double(out, double(value));
+  } else if constexpr (std::is_convertible_v<T const &, std::string_view>) {
+    esc::escape(std::string_view(value), out);
+  } else if constexpr (IS_TYPE(T, JObject)) {
+    value.Write(out);
+  } else if constexpr (is_optional<T>::value) {
+    if (value)
+      write(out, *value);
+    else
+      out.append("null", 4);
+  } else if constexpr (Reflectable<T>) {
+    write_fields(
+        out, value,
+        std::make_index_sequence<std::tuple_size_v<
+            std::remove_const_t<decltype(T::json_fields)>>>{});
+  } else if constexpr (std::ranges::range<T>) {
+    out.push_back('[');
+    bool first = true;
+    for (auto const &item : value) {
+      if (!first)
+        out.push_back(',');
+      first = false;
+      write(out, item);
+    }
+    out.push_back(']');
+  } else {
+    static_assert(IS_TYPE(T, void), "unsupported type in reflect::write()");
+  }
+}
+
+/*
+ * ----------------------------- 反序列化 -----------------------------
+ * 下面的函数模板里的 P 就是 Parser（Parser.h 包含了这个文件，这里还看不到它的定义），
+ * 用到的是它的 get_next_token/parse_xxx/skip_value/pos/seek。
+ */
+
+/**
+ * 编译期生成的 key 查找表（完美 hash）：
+ * 只用长度、第一个、中间的和最后一个字节算 hash，再对 mod 取余，
+ * 编译期枚举 mult 和 mod，找一组让所有 key 都不冲突的。
+ * 查找时算一次 hash、查一次表、比较一次字符串。
+ * 枚举最多算 search_budget 次 hash（成员很多时编译期的步数不会爆掉），
+ * 找不到完美 hash 时退化为在按名字排好序的表里二分查找。
+ */
+template <class T> struct key_table {
+  using fields_t = std::remove_const_t<decltype(T::json_fields)>;
+  static constexpr size_t N = std::tuple_size_v<fields_t>;
+  static constexpr size_t SLOTS = 4 * N + 1;
+  static constexpr size_t search_budget = size_t(1) << 12;
+
+  static constexpr std::array<std::string_view, N> names =
+      []<size_t... I>(std::index_sequence<I...>) {
+        return std::array<std::string_view, N>{
+            std::tuple_element_t<I, fields_t>::name...};
+      }(std::make_index_sequence<N>{});
+
+  static constexpr size_t hash(std::string_view key, size_t mult, size_t mod) {
+    size_t h = key.size();
+    if (!key.empty()) {
+      h = h * mult + (uint8_t)key.front();
+      h = h * mult + (uint8_t)key[key.size() / 2];
+      h = h * mult + (uint8_t)key.back();
+    }
+    return h % mod;
+  }
+
+  struct Table {
+    size_t mult{0};
+    size_t mod{0}; /* 0 表示没有找到完美 hash */
+    std::array<int16_t, SLOTS> slots{};
+  };
+  static constexpr Table table = [] {
+    Table t;
+    /*每一轮试一组 mult 和 mod，used[h] == round 表示这一轮 h 已经被占了，
+     * 这样每一轮不用把整个表清一遍*/
+    std::array<uint32_t, SLOTS> used{};
+    uint32_t round = 0;
+    size_t budget = search_budget;
+    for (size_t mod = N; mod <= SLOTS && N > 0 && budget >= N; mod++) {
+      for (size_t mult = 2; mult < 256 && budget >= N; mult++) {
+        round++;
+        bool ok = true;
+        for (size_t i = 0; i < N && ok; i++, budget--) {
+          size_t h = hash(names[i], mult, mod);
+          ok = used[h] != round;
+          used[h] = round;
+        }
+        if (ok) {
+          t.mult = mult;
+          t.mod = mod;
+          t.slots.fill(-1);
+          for (size_t i = 0; i < N; i++)
+            t.slots[hash(names[i], mult, mod)] = int16_t(i);
+          return t;
+        }
+      }
+    }
+    return t;
+  }();
+
+  /* 没有完美 hash 时用的：成员的下标按名字排好序 */
+  static constexpr std::array<uint16_t, N> sorted = [] {
+    std::array<uint16_t, N> order{};
+    for (size_t i = 0; i < N; i++)
+      order[i] = uint16_t(i);
+    std::sort(order.begin(), order.end(),
+              [](uint16_t a, uint16_t b) { return names[a] < names[b]; });
+    return order;
+  }();
+
+  /* 返回 key 是第几个成员，不是任何成员的名字时返回 -1 */
+  static int find(std::string_view key) {
+    if constexpr (table.mod != 0) {
+      int idx = table.slots[hash(key, table.mult, table.mod)];
+      return idx >= 0 && names[idx] == key ? idx : -1;
+    } else {
+      auto it = std::lower_bound(
+          sorted.begin(), sorted.end(), key,
+          [](uint16_t i, std::string_view k) { return names[i] < k; });
+      return it != sorted.end() && names[*it] == key ? int(*it) : -1;
+    }
+  }
+};
+
+template <class P, class T> void read(P &parser, T &value);
+
+/* 运行时的下标转成编译期的下标，读第 idx 个成员 */
+template <class P, class T, size_t... I>
+void read_field(P &parser, T &value, int idx, std::index_sequence<I...>) {
+  ((idx == int(I) ? (read(parser, value.*(std::get<I>(T::json_fields).member)),
+                     true)
+                  : false) ||
+   ...);
+}
+
+/* 除了 optional 之外的成员都是必须的 */
+template <class T, size_t... I>
+void check_required(std::bitset<sizeof...(I)> const &seen,
+                    std::index_sequence<I...>) {
+  using fields_t = std::remove_const_t<decltype(T::json_fields)>;
+  (
+      [&] {
+        using F = std::tuple_element_t<I, fields_t>;
+        if constexpr (!is_optional<typename F::member_type>::value) {
+          if (!seen[I])
+            throw std::logic_error("missing field \"" + std::string(F::name) +
+                                   "\" in FromJson");
+        }
+      }(),
+      ...);
+}
+
+template <class P, class T> void read_fields(P &parser, T &value) {
+  using table = key_table<T>;
+  auto indices = std::make_index_sequence<table::N>{};
+  std::bitset<table::N> seen; /* 出现过的成员 */
+  parser.seek(parser.pos() + 1); /*跳过 { */
+  char ch = parser.get_next_token();
+  while (ch != '}') {
+    if (ch != '"')
+      throw std::logic_error("expected string key in parse dict");
+    int idx = table::find(parser.parse_string());
+    if (parser.get_next_token() != ':')
+      throw std::logic_error("expected ':' in parse dict");
+    parser.seek(parser.pos() + 1);
+    if (idx < 0) {
+      parser.skip_value(); /*不认识的 key 整个跳过，不构建任何节点*/
+    } else {
+      read_field(parser, value, idx, indices);
+      seen.set(idx);
+    }
+    ch = parser.get_next_token();
+    if (ch == ',') {
+      ch = parser.next_after_comma('}');
+    } else if (ch != '}') {
+      throw std::logic_error("expected ',' in parse dict");
+    }
+  }
+  parser.seek(parser.pos() + 1);
+  check_required<T>(seen, indices);
+}
+
+/**
+ * 直接从 token 流读出一个值，支持的类型和 write 一样；
+ * 容器需要有 clear() 和 emplace_back()，比如 vector
+ * @param parser 当前位置是这个值的开头（前面可以有空白和注释）
+ * @param value
+ */
+template <class P, class T> void read(P &parser, T &value) {
+  char ch = parser.get_next_token();
+  if constexpr (IS_TYPE(T, bool_t)) {
+    if (ch != 't' && ch != 'f')
+      THROW_GET_ERROR(BOOL);
+    value = parser.parse_bool();
+  } else if constexpr (std::is_integral_v<T>) {
+    if (ch != '-' && !num::is_digit(ch))
+      THROW_GET_ERROR(INT);
+    num::Number number = parser.parse_number();
+    if (!number.is_int)
+      THROW_GET_ERROR(INT);
+    if (!std::in_range<T>(number.i))
+      throw std::logic_error("integer out of range in FromJson");
+    value = static_cast<T>(number.i);
+  } else if constexpr (std::is_floating_point_v<T>) {
+    if (ch != '-' && !num::is_digit(ch))
+      THROW_GET_ERROR(DOUBLE);
+    num::Number number = parser.parse_number();
+    value = static_cast<T>(number.is_int ? double(number.i) : number.d);
+  } else if constexpr (IS_TYPE(T, str_t)) {
+    if (ch != '"')
+      THROW_GET_ERROR(STRING);
+    value.assign(parser.parse_string());
+  } else if constexpr (IS_TYPE(T, JObject)) {
+    DomBuilder builder;
+    parser.parse_value(builder);
+    value = std::move(builder.result());
+  } else if constexpr (is_optional<T>::value) {
+    if (ch == 'n') {
+      parser.parse_null();
+      value.reset();
+    } else {
+      read(parser, value.emplace());
+    }
+  } else if constexpr (Reflectable<T>) {
+    if (ch != '{')
+      THROW_GET_ERROR(DICT);
+    read_fields(parser, value);
+  } else if constexpr (requires { value.emplace_back(); }) {
+    if (ch != '[')
+      THROW_GET_ERROR(LIST);
+    value.clear();
+    parser.seek(parser.pos() + 1);
+    ch = parser.get_next_token();
+    while (ch != ']') {
+      read(parser, value.emplace_back());
+      ch = parser.get_next_token();
+      if (ch == ',') {
+        ch = parser.next_after_comma(']');
+      } else if (ch != ']') {
+        throw std::logic_error("expected ',' in parse list");
+      }
+    }
+    parser.seek(parser.pos() + 1);
+  } else {
+    static_assert(IS_TYPE(T, void), "unsupported type in reflect::read()");
+  }
+}
+} // namespace reflect
+} // namespace json
+
+#endif // MYJSON_PARSER_REFLECT_H
@@ -0,0 +1,261 @@
+#ifndef MYJSON_PARSER_SCANNER_H
+#define MYJSON_PARSER_SCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/* 编译期选择实现：-mavx2 时用 AVX2，x86-64 默认有 SSE2，其余用标量版本。
+ * 定义 MYJSON_NO_SIMD 可以强制使用标量版本 */
+#if !defined(MYJSON_NO_SIMD) && defined(__AVX2__)
+#define MYJSON_SCAN_AVX2
+#include <immintrin.h>
+#elif !defined(MYJSON_NO_SIMD) &&                                              \
+    (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64))
+#define MYJSON_SCAN_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace json {
+/**
+ * 一个 64 字节块的分类结果，第 i 位对应块里的第 i 个字节
+ */
+struct BlockMasks {
+  uint64_t whitespace; /* 空格 \t \n \r */
+  uint64_t quote;      /* " */
+  uint64_t backslash;  /* \ */
+  uint64_t structural; /* { } [ ] : ,（ParallelParser 切分元素用，Parser 不用） */
+};
+
+namespace scan {
+/* 标量版本用的查表，每个字符属于哪一类 */
+enum : uint8_t { C_WS = 1, C_QUOTE = 2, C_BSLASH = 4, C_STRUCT = 8 };
+struct CharTable {
+  uint8_t cls[256]{};
+  constexpr CharTable() {
+    cls[(uint8_t)' '] = cls[(uint8_t)'\t'] = C_WS;
+    cls[(uint8_t)'\n'] = cls[(uint8_t)'\r'] = C_WS;
+    cls[(uint8_t)'"'] = C_QUOTE;
+    cls[(uint8_t)'\\'] = C_BSLASH;
+    cls[(uint8_t)'{'] = cls[(uint8_t)'}'] = C_STRUCT;
+    cls[(uint8_t)'['] = cls[(uint8_t)']'] = C_STRUCT;
+    cls[(uint8_t)':'] = cls[(uint8_t)','] = C_STRUCT;
+  }
+};
+inline constexpr CharTable char_table{};
+
+inline BlockMasks classify_scalar(const char *p) {
+  BlockMasks m{};
+  for (int i = 0; i < 64; i++) {
+    uint8_t c = char_table.cls[(uint8_t)p[i]];
+    m.whitespace |= uint64_t(c & C_WS) << i;
+    m.quote |= uint64_t((c & C_QUOTE) >> 1) << i;
+    m.backslash |= uint64_t((c & C_BSLASH) >> 2) << i;
+    m.structural |= uint64_t((c & C_STRUCT) >> 3) << i;
+  }
+  return m;
+}
+
+#if defined(MYJSON_SCAN_AVX2)
+/* 一次比较 32 个字节，返回每个字节是否等于 c 的位图 */
+inline uint32_t eq32(__m256i v, char c) {
+  return (uint32_t)_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)));
+}
+inline BlockMasks classify_half(const char *p) {
+  __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+  BlockMasks m;
+  m.whitespace = eq32(v, ' ') | eq32(v, '\t') | eq32(v, '\n') | eq32(v, '\r');
+  m.quote = eq32(v, '"');
+  m.backslash = eq32(v, '\\');
+  m.structural = eq32(v, '{') | eq32(v, '}') | eq32(v, '[') | eq32(v, ']') |
+                 eq32(v, ':') | eq32(v, ',');
+  return m;
+}
+inline BlockMasks classify(const char *p) {
+  BlockMasks lo = classify_half(p), hi = classify_half(p + 32);
+  return {lo.whitespace | hi.whitespace << 32, lo.quote | hi.quote << 32,
+          lo.backslash | hi.backslash << 32,
+          lo.structural | hi.structural << 32};
+}
+#elif defined(MYJSON_SCAN_SSE2)
+/* 一次比较 16 个字节 */
+inline uint64_t eq16(__m128i v, char c) {
+  return (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+}
+inline BlockMasks classify(const char *p) {
+  BlockMasks m{};
+  for (int i = 0; i < 4; i++) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i * 16));
+    int shift = i * 16;
+    m.whitespace |= (eq16(v, ' ') | eq16(v, '\t') | eq16(v, '\n') |
+                     eq16(v, '\r'))
+                    << shift;
+    m.quote |= eq16(v, '"') << shift;
+    m.backslash |= eq16(v, '\\') << shift;
+    m.structural |= (eq16(v, '{') | eq16(v, '}') | eq16(v, '[') |
+                     eq16(v, ']') | eq16(v, ':') | eq16(v, ','))
+                    << shift;
+  }
+  return m;
+}
+#else
+inline BlockMasks classify(const char *p) { return classify_scalar(p); }
+#endif
+
+/* 最低位的 1 的位置，x 不能为 0 */
+inline int ctz(uint64_t x) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long idx;
+  _BitScanForward64(&idx, x);
+  return (int)idx;
+#else
+  return __builtin_ctzll(x);
+#endif
+}
+} // namespace scan
+
+/*
+ ======================================================================
+ |                         Scanner 类定义开始                          |
+ ======================================================================
+ */
+/**
+ * 两阶段扫描：
+ * 第一阶段每次把 WINDOW 个 64 字节的块一口气分类成位图（SIMD），
+ * 第二阶段由 Parser 按位图跳过空白、查找引号，不再逐个字节判断。
+ * 只缓存一个窗口的位图，所以额外的内存是固定的，和输入大小无关。
+ */
+class Scanner {
+public:
+  static constexpr size_t npos = std::string_view::npos;
+
+  void init(std::string_view src) {
+    m_src = src;
+    m_first = npos;
+  }
+  size_t skip_whitespace(size_t pos);
+  size_t find_quote(size_t pos);
+  size_t find_quote(size_t pos, bool &backslash);
+  const BlockMasks &block(size_t idx);
+
+private:
+  template <uint64_t BlockMasks::*Mask> size_t find(size_t pos);
+  void fill(size_t first);
+
+  static constexpr size_t WINDOW = 64; /* 一次分类 64 块，也就是 4KB */
+  std::string_view m_src;
+  size_t m_first{npos}; /* 窗口里第一个块的编号 */
+  BlockMasks m_masks[WINDOW];
+};
+/*
+ ======================================================================
+ |                         Scanner 类定义结束                          |
+ ======================================================================
+ */
+
+/**
+ * 第一阶段：从第 first 块开始分类一个窗口。
+ * 最后不足 64 字节的块拷到补 0 的缓冲区里再分类，避免越界读。
+ * @param first
+ */
+inline void Scanner::fill(size_t first) {
+  m_first = first;
+  const char *data = m_src.data();
+  size_t size = m_src.size();
+  for (size_t i = 0; i < WINDOW; i++) {
+    size_t off = (first + i) * 64;
+    if (off + 64 <= size) {
+      m_masks[i] = scan::classify(data + off);
+    } else if (off < size) {
+      char tail[64]{};
+      std::memcpy(tail, data + off, size - off);
+      m_masks[i] = scan::classify(tail);
+    } else {
+      break;
+    }
+  }
+}
+
+/**
+ * 第 idx 块的位图，不在当前窗口里就先分类
+ * @param idx
+ * @return
+ */
+inline const BlockMasks &Scanner::block(size_t idx) {
+  if (m_first == npos || idx - m_first >= WINDOW)
+    fill(idx);
+  return m_masks[idx - m_first];
+}
+
+/**
+ * 第二阶段：从 pos 开始找第一个 Mask 位为 1 的字节
+ * @return 找不到返回 npos
+ */
+template <uint64_t BlockMasks::*Mask> size_t Scanner::find(size_t pos) {
+  while (pos < m_src.size()) {
+    size_t offset = pos & 63;
+    uint64_t bits = block(pos >> 6).*Mask >> offset;
+    if (bits != 0) {
+      size_t found = pos + scan::ctz(bits);
+      return found < m_src.size() ? found : npos;
+    }
+    pos += 64 - offset; /* 这一块里没有，去下一块 */
+  }
+  return npos;
+}
+
+/**
+ * 跳过空白字符，返回第一个非空白字符的位置（全是空白则返回输入的长度）
+ * @param pos
+ * @return
+ */
+inline size_t Scanner::skip_whitespace(size_t pos) {
+  while (pos < m_src.size()) {
+    size_t offset = pos & 63;
+    /* 取反之后找第一个 1，右移进来的高位也是 1，代表"这一块结束了" */
+    uint64_t bits = ~(block(pos >> 6).whitespace >> offset);
+    if (bits != 0) { /* offset 为 0 且整块都是空白时 bits 为 0 */
+      size_t step = scan::ctz(bits);
+      if (step < 64 - offset) /* 末尾补的 0 也算非空白，所以要和长度比较 */
+        return pos + step < m_src.size() ? pos + step : m_src.size();
+    }
+    pos += 64 - offset;
+  }
+  return m_src.size();
+}
+
+inline size_t Scanner::find_quote(size_t pos) {
+  return find<&BlockMasks::quote>(pos);
+}
+
+/**
+ * 和 find_quote 一样，顺便检查 [pos, 找到的 ") 里有没有 \ ，
+ * 有的话把 backslash 置为 true。同一个块的两个位图一起看，不用再扫描一遍
+ * @param pos
+ * @param backslash
+ * @return
+ */
+inline size_t Scanner::find_quote(size_t pos, bool &backslash) {
+  while (pos < m_src.size()) {
+    size_t offset = pos & 63;
+    const BlockMasks &masks = block(pos >> 6);
+    uint64_t quote = masks.quote >> offset;
+    uint64_t bslash = masks.backslash >> offset;
+    if (quote != 0) {
+      size_t step = scan::ctz(quote);
+      if (bslash & ((uint64_t(1) << step) - 1)) /* 只看 " 之前的 \ */
+        backslash = true;
+      size_t found = pos + step;
+      return found < m_src.size() ? found : npos;
+    }
+    if (bslash != 0)
+      backslash = true;
+    pos += 64 - offset;
+  }
+  return npos;
+}
+} // namespace json
+
+#endif // MYJSON_PARSER_SCANNER_H
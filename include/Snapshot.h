@@ -0,0 +1,462 @@
+#ifndef MYJSON_PARSER_SNAPSHOT_H
+#define MYJSON_PARSER_SNAPSHOT_H
+
+#include "JObject.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace json {
+/**
+ * 快照文件的格式，所有的位置都是相对于文件开头（字符串是相对于字符串区开头）的偏移，
+ * 所以整个文件可以直接 mmap 到任意地址上使用，不需要任何反序列化：
+ *   SnapHeader | 节点区（SnapNode、dict 的 key 表）| 字符串区
+ * 所有的 key 和字符串值放在同一个字符串区里，同样的内容只存一份。
+ * 按本机的字节序写入，header 里记录了字节序，不同的机器上打开会报错。
+ */
+struct SnapNode {
+  uint8_t type; /* TYPE */
+  uint8_t reserved[3];
+  uint32_t size;    /* 字符串的长度，list/dict 的元素个数 */
+  uint64_t payload; /* 整数、浮点数的位、bool；字符串在字符串区的偏移；容器块的偏移 */
+};
+/**
+ * dict 的块：keys[size] | values[size] | order[size]（补齐到 8 字节）
+ * keys 和 values 按插入顺序，order 是按 key 排好序的下标，用来二分查找
+ */
+struct SnapKey {
+  uint32_t size;
+  uint32_t reserved;
+  uint64_t offset; /* 在字符串区的偏移 */
+};
+struct SnapHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t endian;  /* 写入时的 0x01020304 */
+  uint64_t size;    /* 整个文件的大小 */
+  uint64_t strings; /* 字符串区的偏移 */
+  SnapNode root;
+};
+static_assert(sizeof(SnapNode) == 16 && sizeof(SnapKey) == 16 &&
+                  sizeof(SnapHeader) == 48,
+              "snapshot layout must not depend on the compiler");
+
+class Snapshot;
+/*
+ ======================================================================
+ |                      SnapshotValue 类定义开始                        |
+ ======================================================================
+ */
+/**
+ * 快照里的一个值，只是指向快照里的节点，不拷贝任何东西。
+ * 查找的接口和 JObject、LazyValue 一样；dict 的 key 超过 8 个时二分查找。
+ * 只能在 Snapshot 活着的时候使用（Snapshot 移动之后依然有效）。
+ */
+class SnapshotValue {
+public:
+  TYPE Type() const { return static_cast<TYPE>(m_node->type); }
+  SnapshotValue operator[](string_view key) const;
+  SnapshotValue operator[](size_t index) const;
+  /* 和 operator[] 一样，但是找不到（或者类型不对）时返回空，不抛异常。
+   * 下标对 dict 也可以用，按插入的顺序 */
+  std::optional<SnapshotValue> Find(string_view key) const;
+  std::optional<SnapshotValue> Find(size_t index) const;
+  /* dict 的第 index 个 key，和 Find(index) 配合遍历 dict */
+  string_view Key(size_t index) const;
+  size_t Size() const;
+  /* 和 JObject::Value 一样，类型不对时抛出异常；str_view_t 指向快照，不拷贝 */
+  template <class V> V Value() const;
+  /* 把这个值（包括所有子节点）拷贝成 JObject */
+  JObject ToJObject() const;
+
+private:
+  friend class Snapshot;
+  SnapshotValue(const char *base, SnapNode const *node)
+      : m_base(base), m_node(node) {}
+  SnapshotValue child(size_t index) const { return {m_base, values() + index}; }
+  SnapHeader const &header() const {
+    return *reinterpret_cast<SnapHeader const *>(m_base);
+  }
+  const char *block() const;
+  string_view str(uint64_t offset, uint32_t size) const;
+  SnapKey const *keys() const {
+    return reinterpret_cast<SnapKey const *>(block());
+  }
+  SnapNode const *values() const {
+    return reinterpret_cast<SnapNode const *>(
+        m_node->type == T_DICT ? block() + sizeof(SnapKey) * m_node->size
+                               : block());
+  }
+
+  const char *m_base; /* 快照的开头 */
+  SnapNode const *m_node;
+};
+/*
+ ======================================================================
+ |                      SnapshotValue 类定义结束                        |
+ ======================================================================
+ */
+
+/*
+ ======================================================================
+ |                        Snapshot 类定义开始                           |
+ ======================================================================
+ */
+/**
+ * 二进制快照：把解析好的 JObject 树写成一个文件，下次启动时直接 mmap，
+ * 不需要再解析 JSON，也不需要构建 JObject 树。
+ *   Snapshot::Save(Parser::FromFile("config.json"), "config.snap");
+ *   Snapshot snapshot = Snapshot::Open("config.snap");
+ *   auto mode = snapshot.Root()["editor"]["mode"].Value<str_view_t>();
+ * 打开时只检查 header；每个节点在访问的时候才检查偏移有没有越界，
+ * 损坏的文件会在访问到坏掉的节点时抛出异常，不会读到文件外面。
+ */
+class Snapshot {
+public:
+  /* 把 root 写成快照格式 */
+  static std::string Build(JObject const &root);
+  static void Save(JObject const &root, std::string const &path);
+  /* mmap 打开快照文件 */
+  static Snapshot Open(std::string const &path);
+  /* 使用内存里的快照（比如 Build 的结果），bytes 被移动进来 */
+  explicit Snapshot(std::string bytes) : m_bytes(std::move(bytes)) {
+    check(m_bytes);
+  }
+  Snapshot(Snapshot const &) = delete;
+  Snapshot &operator=(Snapshot const &) = delete;
+  Snapshot(Snapshot &&) = default;
+  Snapshot &operator=(Snapshot &&) = default;
+
+  SnapshotValue Root() const { return {data().data(), &header()->root}; }
+  size_t Bytes() const { return data().size(); }
+
+private:
+  class Writer;
+  explicit Snapshot(MappedFile file) : m_file(std::move(file)) {
+    check(m_file.view());
+  }
+  static void check(string_view data);
+  /* 映射的文件和 string 的缓冲区在移动之后地址都不变 */
+  string_view data() const {
+    return m_file.data() ? m_file.view() : string_view(m_bytes);
+  }
+  SnapHeader const *header() const {
+    return reinterpret_cast<SnapHeader const *>(data().data());
+  }
+
+  MappedFile m_file;
+  std::string m_bytes;
+};
+/*
+ ======================================================================
+ |                         Snapshot 类定义结束                          |
+ ======================================================================
+ */
+
+/**
+ * 把 JObject 树写成快照：容器的块先占好位置，再依次写每个子节点，
+ * 子容器的块接着追加在后面；字符串先去重再追加到字符串区
+ */
+class Snapshot::Writer {
+public:
+  std::string Build(JObject const &root) {
+    m_nodes.assign(sizeof(SnapHeader), '\0');
+    SnapHeader header{};
+    std::memcpy(header.magic, "MJSNAP\0\0", 8);
+    header.version = 1;
+    header.endian = 0x01020304;
+    header.root = node(root);
+    header.strings = m_nodes.size();
+    header.size = m_nodes.size() + m_strings.size();
+    std::memcpy(m_nodes.data(), &header, sizeof(header));
+    m_nodes += m_strings;
+    return std::move(m_nodes);
+  }
+
+private:
+  static uint32_t check_size(size_t size) {
+    if (size > UINT32_MAX)
+      throw std::length_error("too many elements in Snapshot::Build");
+    return uint32_t(size);
+  }
+  /* 在节点区占 bytes 个字节（补齐到 8 字节），返回偏移 */
+  size_t reserve(size_t bytes) {
+    size_t offset = m_nodes.size();
+    m_nodes.resize(offset + ((bytes + 7) & ~size_t(7)), '\0');
+    return offset;
+  }
+  template <class T> void put(size_t offset, T const &value) {
+    std::memcpy(m_nodes.data() + offset, &value, sizeof(T));
+  }
+  uint64_t add_string(string_view str) {
+    auto it = m_offsets.find(str);
+    if (it != m_offsets.end())
+      return it->second;
+    uint64_t offset = m_strings.size();
+    m_strings.append(str);
+    m_offsets.try_emplace(str, offset);
+    return offset;
+  }
+  SnapNode node(JObject const &value);
+
+  std::string m_nodes;
+  std::string m_strings;
+  basic_dict<uint64_t> m_offsets; /* 字符串区里已有的字符串 */
+};
+
+inline SnapNode Snapshot::Writer::node(JObject const &value) {
+  SnapNode node{};
+  node.type = uint8_t(value.Type());
+  switch (value.Type()) {
+  case T_NULL:
+    break;
+  case T_BOOL:
+    node.payload = value.Value<bool_t>();
+    break;
+  case T_INT:
+    std::memcpy(&node.payload, &value.Value<int_t>(), 8);
+    break;
+  case T_DOUBLE:
+    std::memcpy(&node.payload, &value.Value<double_t>(), 8);
+    break;
+  case T_STR: {
+    str_view_t str = value.Value<str_view_t>();
+    node.size = uint32_t(str.size());
+    node.payload = add_string(str);
+    break;
+  }
+  case T_LIST: {
+    auto &list = value.Value<list_t>();
+    node.size = check_size(list.size());
+    size_t offset = reserve(sizeof(SnapNode) * list.size());
+    node.payload = offset;
+    for (size_t i = 0; i < list.size(); i++)
+      put(offset + sizeof(SnapNode) * i, this->node(list[i]));
+    break;
+  }
+  case T_DICT: {
+    auto &dict = value.Value<dict_t>();
+    size_t n = check_size(dict.size());
+    node.size = uint32_t(n);
+    size_t offset = reserve((sizeof(SnapKey) + sizeof(SnapNode) +
+                             sizeof(uint32_t)) * n);
+    node.payload = offset;
+    std::vector<std::pair<string_view, uint32_t>> order;
+    order.reserve(n);
+    size_t i = 0;
+    for (auto &[key, child] : dict) {
+      string_view name = key;
+      put(offset + sizeof(SnapKey) * i,
+          SnapKey{uint32_t(name.size()), 0, add_string(name)});
+      put(offset + sizeof(SnapKey) * n + sizeof(SnapNode) * i,
+          this->node(child));
+      order.emplace_back(name, uint32_t(i));
+      i++;
+    }
+    std::sort(order.begin(), order.end());
+    size_t base = offset + (sizeof(SnapKey) + sizeof(SnapNode)) * n;
+    for (i = 0; i < n; i++)
+      put(base + sizeof(uint32_t) * i, order[i].second);
+    break;
+  }
+  }
+  return node;
+}
+
+inline std::string Snapshot::Build(JObject const &root) {
+  return Writer().Build(root);
+}
+
+inline void Snapshot::Save(JObject const &root, std::string const &path) {
+  std::string bytes = Build(root);
+  std::ofstream fout(path, std::ios::binary);
+  if (!fout.write(bytes.data(), std::streamsize(bytes.size())))
+    throw std::logic_error("can not write file in Snapshot::Save");
+}
+
+inline Snapshot Snapshot::Open(std::string const &path) {
+  return Snapshot(MappedFile(path));
+}
+
+/* 只检查 header：魔数、版本、字节序、大小 */
+inline void Snapshot::check(string_view data) {
+  SnapHeader header;
+  if (data.size() < sizeof(header))
+    throw std::logic_error("invalid snapshot! Snapshot::check()");
+  std::memcpy(&header, data.data(), sizeof(header));
+  if (std::memcmp(header.magic, "MJSNAP\0\0", 8) != 0 || header.version != 1 ||
+      header.endian != 0x01020304 || header.size != data.size() ||
+      header.strings > data.size())
+    throw std::logic_error("invalid snapshot! Snapshot::check()");
+}
+
+/**
+ * 容器的块，检查它在节点区里面、8 字节对齐，并且在这个节点的后面
+ * （写的时候子容器的块总是追加在后面，所以损坏的文件也不会绕成环）
+ * @return
+ */
+inline const char *SnapshotValue::block() const {
+  uint64_t offset = m_node->payload;
+  uint64_t bytes = m_node->type == T_DICT
+                       ? (sizeof(SnapKey) + sizeof(SnapNode) +
+                          sizeof(uint32_t)) * uint64_t(m_node->size)
+                       : sizeof(SnapNode) * uint64_t(m_node->size);
+  uint64_t self = uint64_t(reinterpret_cast<const char *>(m_node) - m_base);
+  uint64_t end = header().strings;
+  if (offset % 8 != 0 || offset < self + sizeof(SnapNode) || offset > end ||
+      bytes > end - offset)
+    throw std::logic_error("invalid snapshot! SnapshotValue::block()");
+  return m_base + offset;
+}
+
+/* 字符串区里的字符串，检查它没有超出文件 */
+inline string_view SnapshotValue::str(uint64_t offset, uint32_t size) const {
+  uint64_t strings = header().strings;
+  uint64_t length = header().size - strings;
+  if (offset > length || size > length - offset)
+    throw std::logic_error("invalid snapshot! SnapshotValue::str()");
+  return {m_base + strings + offset, size};
+}
+
+inline size_t SnapshotValue::Size() const {
+  if (m_node->type != T_LIST && m_node->type != T_DICT)
+    throw std::logic_error("type error in SnapshotValue::Size()");
+  return m_node->size;
+}
+
+inline string_view SnapshotValue::Key(size_t index) const {
+  if (m_node->type != T_DICT || index >= m_node->size)
+    throw std::logic_error("index out of range in SnapshotValue::Key()");
+  SnapKey const &key = keys()[index];
+  return str(key.offset, key.size);
+}
+
+inline std::optional<SnapshotValue> SnapshotValue::Find(size_t index) const {
+  if ((m_node->type != T_LIST && m_node->type != T_DICT) ||
+      index >= m_node->size)
+    return std::nullopt;
+  return child(index);
+}
+
+/**
+ * key 不多时顺序比较，多的话在排好序的 order 上二分查找
+ * @param key
+ * @return
+ */
+inline std::optional<SnapshotValue>
+SnapshotValue::Find(string_view key) const {
+  if (m_node->type != T_DICT)
+    return std::nullopt;
+  size_t n = m_node->size;
+  SnapKey const *table = keys();
+  if (n <= 8) {
+    for (size_t i = 0; i < n; i++)
+      if (str(table[i].offset, table[i].size) == key)
+        return child(i);
+    return std::nullopt;
+  }
+  auto order = reinterpret_cast<uint32_t const *>(
+      block() + (sizeof(SnapKey) + sizeof(SnapNode)) * n);
+  auto at = [&](uint32_t i) {
+    if (i >= n)
+      throw std::logic_error("invalid snapshot! SnapshotValue::Find()");
+    return str(table[i].offset, table[i].size);
+  };
+  auto it = std::lower_bound(
+      order, order + n, key,
+      [&](uint32_t i, string_view key) { return at(i) < key; });
+  if (it == order + n || at(*it) != key)
+    return std::nullopt;
+  return child(*it);
+}
+
+inline SnapshotValue SnapshotValue::operator[](string_view key) const {
+  if (auto value = Find(key))
+    return *value;
+  if (m_node->type != T_DICT)
+    throw std::logic_error("not dict type! SnapshotValue::operator[]()");
+  throw std::logic_error("key not found in SnapshotValue::operator[]");
+}
+
+inline SnapshotValue SnapshotValue::operator[](size_t index) const {
+  if (auto value = Find(index))
+    return *value;
+  if (m_node->type != T_LIST && m_node->type != T_DICT)
+    throw std::logic_error("not list type! SnapshotValue::operator[]()");
+  throw std::logic_error("index out of range in SnapshotValue::operator[]");
+}
+
+template <class V> V SnapshotValue::Value() const {
+  if constexpr (IS_TYPE(V, bool_t)) {
+    if (m_node->type != T_BOOL)
+      THROW_GET_ERROR(BOOL);
+    return m_node->payload != 0;
+  } else if constexpr (std::is_integral_v<V>) {
+    if (m_node->type != T_INT)
+      THROW_GET_ERROR(INT);
+    int_t value;
+    std::memcpy(&value, &m_node->payload, 8);
+    if (!std::in_range<V>(value))
+      throw std::logic_error("integer out of range in SnapshotValue::Value()");
+    return static_cast<V>(value);
+  } else if constexpr (IS_TYPE(V, double_t)) {
+    if (m_node->type != T_DOUBLE)
+      THROW_GET_ERROR(DOUBLE);
+    double_t value;
+    std::memcpy(&value, &m_node->payload, 8);
+    return value;
+  } else if constexpr (IS_TYPE(V, str_t) || IS_TYPE(V, str_view_t)) {
+    if (m_node->type != T_STR)
+      THROW_GET_ERROR(STRING);
+    return V(str(m_node->payload, m_node->size));
+  } else {
+    static_assert(IS_TYPE(V, void), "unknown type in SnapshotValue::Value()");
+  }
+}
+
+inline JObject SnapshotValue::ToJObject() const {
+  switch (m_node->type) {
+  case T_BOOL:
+    return JObject(Value<bool_t>());
+  case T_INT:
+    return JObject(Value<int_t>());
+  case T_DOUBLE:
+    return JObject(Value<double_t>());
+  case T_STR: {
+    JObject str;
+    str.Str(Value<str_view_t>());
+    return str;
+  }
+  case T_LIST: {
+    JObject list(T_LIST, nullptr);
+    auto &items = list.Value<list_t>();
+    block(); /*先检查块没有越界，损坏的 size 不会 reserve 出很大的空间*/
+    items.reserve(m_node->size);
+    for (size_t i = 0; i < m_node->size; i++)
+      items.push_back(child(i).ToJObject());
+    return list;
+  }
+  case T_DICT: {
+    JObject dict(T_DICT, nullptr);
+    auto &members = dict.Value<dict_t>();
+    block();
+    members.reserve(m_node->size);
+    for (size_t i = 0; i < m_node->size; i++)
+      members.try_emplace(Key(i), child(i).ToJObject());
+    return dict;
+  }
+  default:
+    return JObject();
+  }
+}
+} // namespace json
+
+#endif // MYJSON_PARSER_SNAPSHOT_H
@@ -0,0 +1,126 @@
+#ifndef MYJSON_PARSER_STATS_H
+#define MYJSON_PARSER_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+
+namespace json {
+/*
+ ======================================================================
+ |                        Stats 类定义开始                              |
+ ======================================================================
+ */
+/**
+ * 一次解析或者序列化做了多少事情；同样的结构也用来累加一个线程所有的调用。
+ * 只统计 Parser 的解析（FromString、FromStringView、FromFile、事件模式等）
+ * 和 JObject::ToString，打开 Instrument 之后才会统计。
+ * ParallelParser::Parse 和 NdJsonReader::Read/ReadFile 在工作线程里解析，
+ * 各线程的结果合并之后在调用线程里记成一次。
+ */
+struct Stats {
+  size_t parses = 0;   /* 解析的次数 */
+  size_t bytes_in = 0; /* 解析消耗的输入字节数 */
+  /* 各种类型的节点个数，下标是 TYPE（T_NULL ... T_DICT） */
+  size_t nodes[7] = {};
+  size_t max_depth = 0; /* 最深的嵌套层数，顶层的 list/dict 是第 1 层 */
+  size_t comments = 0;  /* 跳过的 // 注释行数 */
+  /* 分配了内存的字符串和 key 的个数，直接放在节点里的、借用输入或者 intern 表的不算 */
+  size_t strings = 0;
+  /* 字符串、key 和容器分配的字节数（估算，不含树外面的 JObject 本身） */
+  size_t bytes_allocated = 0;
+  double parse_seconds = 0;
+  size_t serializes = 0; /* 序列化的次数 */
+  size_t bytes_out = 0;  /* 序列化输出的字节数 */
+  double serialize_seconds = 0;
+
+  size_t Nodes() const {
+    size_t n = 0;
+    for (size_t count : nodes)
+      n += count;
+    return n;
+  }
+  /* 累加另一次调用的结果，max_depth 取较大的那个 */
+  void Add(Stats const &other) {
+    parses += other.parses;
+    bytes_in += other.bytes_in;
+    for (size_t i = 0; i < std::size(nodes); i++)
+      nodes[i] += other.nodes[i];
+    if (other.max_depth > max_depth)
+      max_depth = other.max_depth;
+    comments += other.comments;
+    strings += other.strings;
+    bytes_allocated += other.bytes_allocated;
+    parse_seconds += other.parse_seconds;
+    serializes += other.serializes;
+    bytes_out += other.bytes_out;
+    serialize_seconds += other.serialize_seconds;
+  }
+};
+/*
+ ======================================================================
+ |                        Stats 类定义结束                              |
+ ======================================================================
+ */
+
+/*
+ ======================================================================
+ |                      Instrument 类定义开始                           |
+ ======================================================================
+ */
+/**
+ * 统计的开关和结果。默认关闭，关闭时每次调用只多读一次 atomic<bool>；
+ * 打开之后每次调用结束时把这次的结果放进 Last()，再累加到 Thread()。
+ * 结果都是 thread_local 的，每个线程只看到自己的调用，不需要加锁；
+ * 要汇总整个进程的话由各个线程把 Thread() 的结果交给自己的指标系统。
+ */
+class Instrument {
+public:
+  /* 整个进程打开或者关闭统计 */
+  static void Enable(bool on = true) {
+    enabled().store(on, std::memory_order_relaxed);
+  }
+  static bool Enabled() { return enabled().load(std::memory_order_relaxed); }
+  /* 这个线程最近一次解析或者序列化的结果 */
+  static Stats const &Last() { return last(); }
+  /* 这个线程从上次 Reset 以来所有调用的累计 */
+  static Stats const &Thread() { return total(); }
+  /* 清空这个线程的结果 */
+  static void Reset() {
+    last() = Stats();
+    total() = Stats();
+  }
+  /* 一次调用结束，由 Parser 和 JObject 调用 */
+  static void Record(Stats const &stats) {
+    last() = stats;
+    total().Add(stats);
+  }
+  static double Now() {
+    return std::chrono::duration<double>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+private:
+  static std::atomic<bool> &enabled() {
+    static std::atomic<bool> on{false};
+    return on;
+  }
+  static Stats &last() {
+    thread_local Stats stats;
+    return stats;
+  }
+  static Stats &total() {
+    thread_local Stats stats;
+    return stats;
+  }
+};
+/*
+ ======================================================================
+ |                      Instrument 类定义结束                           |
+ ======================================================================
+ */
+} // namespace json
+
+#endif // MYJSON_PARSER_STATS_H
@@ -0,0 +1,350 @@
+#ifndef MYJSON_PARSER_STREAMPARSER_H
+#define MYJSON_PARSER_STREAMPARSER_H
+
+#include "Escape.h"
+#include "Handler.h"
+#include "Number.h"
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace json {
+/*
+ ======================================================================
+ |                      StreamParser 类定义开始                         |
+ ======================================================================
+ */
+/**
+ * 增量解析器：输入可以分成任意大小的块，一块一块地 feed 进来，
+ * token 被切断也没关系（字符串、数字、true/false/null、// 注释都可以跨块），
+ * 每解析完一个 token 就立刻调用 handler 的方法（事件接口见 Handler.h）。
+ *
+ * 和 Parser 不同，这里没有递归，嵌套关系保存在 m_stack 里；
+ * 除了 handler 自己，占用的内存只和嵌套深度、跨块 token 的长度有关。
+ * 连续的多个顶层值（比如每行一个 JSON）会依次解析，values() 返回已完成的个数。
+ *
+ * @tparam Handler 比如 DomBuilder，或者自己继承 BaseHandler 写的类
+ */
+template <class Handler> class StreamParser {
+public:
+  /* syntax 为 SYNTAX_JSONC 时接受末尾多一个逗号，和 Parser 一样 */
+  explicit StreamParser(Handler &handler, SYNTAX syntax = SYNTAX_STRICT)
+      : m_handler(handler), m_trailing_commas(syntax == SYNTAX_JSONC) {}
+
+  void feed(string_view chunk);
+  void finish();
+  /* 已经完整解析出来的顶层值的个数 */
+  size_t values() const { return m_values; }
+
+private:
+  /* token 之间，下一个期待的是什么 */
+  enum State {
+    S_VALUE,        /* 一个值 */
+    S_ARRAY_FIRST,  /* [ 之后：一个值或者 ] */
+    S_ARRAY_NEXT,   /* list 里的 , 之后：一个值（JSONC 还可以是 ]） */
+    S_OBJECT_FIRST, /* { 之后：key 或者 } */
+    S_OBJECT_KEY,   /* dict 里的 , 之后：key（JSONC 还可以是 }） */
+    S_COLON,        /* key 之后的 : */
+    S_AFTER_VALUE   /* 值之后：, 或者 ] } */
+  };
+  /* 正在读的、可能跨块的 token */
+  enum Lexeme { L_NONE, L_STRING, L_NUMBER, L_LITERAL, L_SLASH, L_COMMENT };
+
+  void value_done();
+  void start_token(string_view chunk, size_t &i);
+  bool continue_token(string_view chunk, size_t &i);
+  void emit_string(string_view str);
+  void emit_number(string_view text);
+  void emit_literal();
+  [[noreturn]] static void error(char const *msg) {
+    throw std::logic_error(msg);
+  }
+
+  Handler &m_handler;
+  bool m_trailing_commas; /* 接受末尾多一个逗号 */
+  State m_state{S_VALUE};
+  Lexeme m_lex{L_NONE};
+  std::vector<char> m_stack; /* 还没结束的 [ 和 { */
+  std::string m_token;       /* 跨块 token 已经读到的部分 */
+  bool m_token_is_key{false};
+  bool m_escape{false};      /* 字符串里上一个字符是没有被抵消的 \ */
+  bool m_has_escape{false};  /* 当前字符串里有没有转义，有的话要解码 */
+  std::string m_unescaped;   /* 解码之后的字符串 */
+  char const *m_literal{};   /* 正在匹配的 true/false/null */
+  size_t m_values{0};
+};
+/*
+ ======================================================================
+ |                      StreamParser 类定义结束                         |
+ ======================================================================
+ */
+
+/**
+ * 喂进一块输入，这一块里完整的 token 都会立刻变成事件
+ * @param chunk 调用结束之后就可以释放或者复用
+ */
+template <class Handler> void StreamParser<Handler>::feed(string_view chunk) {
+  size_t i = 0;
+  /* 先把上一块留下的半个 token 读完 */
+  if (m_lex != L_NONE && !continue_token(chunk, i))
+    return;
+  while (i < chunk.size()) {
+    char ch = chunk[i];
+    if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r') {
+      i++;
+      continue;
+    }
+    switch (ch) {
+    case '[':
+    case '{':
+      if (m_state != S_VALUE && m_state != S_ARRAY_FIRST &&
+          m_state != S_ARRAY_NEXT)
+        error("unexpected character in parse json");
+      m_stack.push_back(ch);
+      if (ch == '[') {
+        m_handler.start_array();
+        m_state = S_ARRAY_FIRST;
+      } else {
+        m_handler.start_object();
+        m_state = S_OBJECT_FIRST;
+      }
+      i++;
+      break;
+    case ']':
+      if (m_stack.empty() || m_stack.back() != '[' ||
+          (m_state != S_ARRAY_FIRST && m_state != S_ARRAY_NEXT &&
+           m_state != S_AFTER_VALUE))
+        error("expected ',' in parse list");
+      if (m_state == S_ARRAY_NEXT && !m_trailing_commas)
+        error("trailing comma in parse json");
+      m_stack.pop_back();
+      m_handler.end_array();
+      i++;
+      value_done();
+      break;
+    case '}':
+      if (m_stack.empty() || m_stack.back() != '{' ||
+          (m_state != S_OBJECT_FIRST && m_state != S_OBJECT_KEY &&
+           m_state != S_AFTER_VALUE))
+        error("expected ',' in parse dict");
+      if (m_state == S_OBJECT_KEY && !m_trailing_commas)
+        error("trailing comma in parse json");
+      m_stack.pop_back();
+      m_handler.end_object();
+      i++;
+      value_done();
+      break;
+    case ',':
+      if (m_state != S_AFTER_VALUE || m_stack.empty())
+        error("unexpected ',' in parse json");
+      m_state = m_stack.back() == '[' ? S_ARRAY_NEXT : S_OBJECT_KEY;
+      i++;
+      break;
+    case ':':
+      if (m_state != S_COLON)
+        error("expected ':' in parse dict");
+      m_state = S_VALUE;
+      i++;
+      break;
+    default:
+      start_token(chunk, i);
+      if (!continue_token(chunk, i))
+        return; /* token 被这一块的末尾截断了，等下一块 */
+      break;
+    }
+  }
+}
+
+/**
+ * 输入结束。末尾的数字只有到这里才知道已经结束了
+ */
+template <class Handler> void StreamParser<Handler>::finish() {
+  if (m_lex == L_NUMBER) {
+    emit_number(m_token);
+    m_lex = L_NONE;
+  } else if (m_lex == L_COMMENT) {
+    m_lex = L_NONE; /* 注释一直到文件末尾也可以 */
+  } else if (m_lex != L_NONE) {
+    error("unexpected end of input in parse json");
+  }
+  if (!m_stack.empty() || m_state != S_VALUE || m_values == 0)
+    error("unexpected end of input in parse json");
+}
+
+/**
+ * 一个完整的值结束了，决定下一步期待什么
+ */
+template <class Handler> void StreamParser<Handler>::value_done() {
+  if (m_stack.empty()) {
+    m_values++;
+    m_state = S_VALUE; /* 可以接着解析下一个顶层值 */
+  } else {
+    m_state = S_AFTER_VALUE;
+  }
+}
+
+/**
+ * 根据第一个字符判断 token 的种类，并检查当前状态允不允许出现它
+ * @param chunk
+ * @param i 指向 token 的第一个字符
+ */
+template <class Handler>
+void StreamParser<Handler>::start_token(string_view chunk, size_t &i) {
+  char ch = chunk[i];
+  m_token.clear();
+  if (ch == '/') {
+    m_lex = L_SLASH;
+    i++;
+    return;
+  }
+  bool want_key = m_state == S_OBJECT_FIRST || m_state == S_OBJECT_KEY;
+  bool want_value = m_state == S_VALUE || m_state == S_ARRAY_FIRST ||
+                    m_state == S_ARRAY_NEXT;
+  if (ch == '"') {
+    if (!want_key && !want_value)
+      error("unexpected string in parse json");
+    m_lex = L_STRING;
+    m_token_is_key = want_key;
+    m_escape = false;
+    m_has_escape = false;
+    i++; /* 跳过左边的 " */
+    return;
+  }
+  if (!want_value)
+    error(want_key           ? "expected string key in parse dict"
+          : m_state == S_COLON ? "expected ':' in parse dict"
+                               : "unexpected character in parse json");
+  if (ch == '-' || num::is_digit(ch)) {
+    m_lex = L_NUMBER;
+  } else if (ch == 't' || ch == 'f' || ch == 'n') {
+    m_lex = L_LITERAL;
+    m_literal = ch == 't' ? "true" : ch == 'f' ? "false" : "null";
+  } else {
+    error("unexpected character in parse json");
+  }
+}
+
+/**
+ * 继续读当前的 token
+ * @param chunk
+ * @param i 读完之后指向 token 之后的第一个字符
+ * @return token 在这一块里结束了返回 true；读到块的末尾还没结束返回 false，
+ *         已经读到的部分存在 m_token 里
+ */
+template <class Handler>
+bool StreamParser<Handler>::continue_token(string_view chunk, size_t &i) {
+  size_t begin = i;
+  switch (m_lex) {
+  case L_STRING:
+    for (; i < chunk.size(); i++) {
+      char ch = chunk[i];
+      if (m_escape) {
+        m_escape = false;
+      } else if (ch == '\\') {
+        m_escape = m_has_escape = true;
+      } else if (ch == '"') {
+        /* 整个字符串都在这一块里的话，直接把视图交出去，不拷贝 */
+        if (m_token.empty())
+          emit_string(chunk.substr(begin, i - begin));
+        else
+          emit_string(m_token.append(chunk.substr(begin, i - begin)));
+        i++; /* 跳过右边的 " */
+        m_lex = L_NONE;
+        return true;
+      }
+    }
+    break;
+  case L_NUMBER:
+    for (; i < chunk.size(); i++) {
+      char ch = chunk[i];
+      if (!num::is_digit(ch) && ch != '-' && ch != '+' && ch != '.' &&
+          ch != 'e' && ch != 'E') {
+        if (m_token.empty())
+          emit_number(chunk.substr(begin, i - begin));
+        else
+          emit_number(m_token.append(chunk.substr(begin, i - begin)));
+        m_lex = L_NONE;
+        return true;
+      }
+    }
+    break;
+  case L_LITERAL:
+    /* 一个字符一个字符地和 true/false/null 比较 */
+    for (; i < chunk.size(); i++) {
+      size_t pos = m_token.size();
+      if (chunk[i] != m_literal[pos])
+        error("parse literal error");
+      m_token.push_back(chunk[i]);
+      if (m_literal[pos + 1] == '\0') {
+        i++;
+        emit_literal();
+        m_lex = L_NONE;
+        return true;
+      }
+    }
+    return false;
+  case L_SLASH: /* 注释必须是 // */
+    if (i == chunk.size())
+      return false;
+    if (chunk[i] != '/')
+      error("invalid comment area!");
+    m_lex = L_COMMENT;
+    i++;
+    [[fallthrough]];
+  case L_COMMENT:
+    for (; i < chunk.size(); i++) {
+      if (chunk[i] == '\n') {
+        i++;
+        m_lex = L_NONE;
+        return true;
+      }
+    }
+    return false;
+  case L_NONE:
+    return true;
+  }
+  /* 字符串或者数字被截断了，先把这一段存起来 */
+  m_token.append(chunk.substr(begin));
+  return false;
+}
+
+template <class Handler>
+void StreamParser<Handler>::emit_string(string_view str) {
+  if (m_has_escape) {
+    m_unescaped.resize(str.size());
+    str = {m_unescaped.data(), esc::unescape(str, m_unescaped.data())};
+  }
+  if (m_token_is_key) {
+    m_handler.key(str);
+    m_state = S_COLON;
+  } else {
+    m_handler.str(str);
+    value_done();
+  }
+}
+
+template <class Handler>
+void StreamParser<Handler>::emit_number(string_view text) {
+  num::Number number{};
+  const char *end =
+      num::parse_number(text.data(), text.data() + text.size(), number);
+  if (end != text.data() + text.size())
+    error("invalid character in number");
+  if (number.is_int)
+    m_handler.integer(number.i);
+  else
+    m_handler.number(number.d);
+  value_done();
+}
+
+template <class Handler> void StreamParser<Handler>::emit_literal() {
+  if (m_literal[0] == 'n')
+    m_handler.null();
+  else
+    m_handler.boolean(m_literal[0] == 't');
+  value_done();
+}
+} // namespace json
+
+#endif // MYJSON_PARSER_STREAMPARSER_H
@@ -0,0 +1,311 @@
+/*生成基准测试用的 JSON 文件：每种文件对应一种典型的负载，同样的种子生成的文件完全一样。
+ *   numbers   数字为主的数组（整数、负数、小数、指数）
+ *   escapes   含有大量转义（\" \\ \n \uXXXX 代理对）的长字符串
+ *   deep      很深的嵌套（list 和 dict 交替）
+ *   wide      有几千个 key 的 dict
+ *   records   同样结构的记录组成的数组（日志、接口返回的列表）
+ *   comments  vscode 风格、注释很多的配置文件
+ * 用法：MyJson_Parser_corpus [--seed N] [--size 字节数] [--depth N] [--width N]
+ *                            [--out 目录] [文件的种类 ...]
+ * 生成之后：MyJson_Parser_benchmark --dir 目录 */
+#include "../include/Parser.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+using std::string;
+
+/* 自己写的随机数：std::uniform_int_distribution 在不同的标准库里结果不一样，
+ * 这里只用 mt19937_64 本身的输出，保证同样的种子在哪里生成的文件都一样。
+ * 函数的参数、一串 + 的操作数的求值顺序是不确定的，所以同一个表达式里
+ * 最多只取一次随机数，要用多个的话先按顺序取到局部变量里 */
+class Random {
+public:
+  explicit Random(uint64_t seed) : m_engine(seed) {}
+  /* [0, n) */
+  uint64_t below(uint64_t n) { return m_engine() % n; }
+  bool chance(int percent) { return below(100) < uint64_t(percent); }
+  string word(size_t min_len, size_t max_len) {
+    size_t len = min_len + below(max_len - min_len + 1);
+    string out;
+    for (size_t i = 0; i < len; i++)
+      out += char('a' + below(26));
+    return out;
+  }
+
+private:
+  std::mt19937_64 m_engine;
+};
+
+struct Options {
+  uint64_t seed = 42;
+  size_t size = size_t(4) << 20; /*每个文件大约多少字节*/
+  size_t depth = 512;            /*deep 的嵌套层数*/
+  size_t width = 4096;           /*wide 的每个 dict 有几个 key*/
+  string out = "corpus";
+};
+
+/* 一个数字：整数、负数、小数、科学计数法都有 */
+void number(Random &rng, string &out) {
+  char buf[64];
+  switch (rng.below(4)) {
+  case 0:
+    snprintf(buf, sizeof(buf), "%llu", (unsigned long long)rng.below(1000));
+    break;
+  case 1:
+    snprintf(buf, sizeof(buf), "-%llu",
+             (unsigned long long)rng.below(uint64_t(1) << 62));
+    break;
+  case 2: {
+    unsigned long long whole = rng.below(100000);
+    unsigned long long fraction = rng.below(1000000);
+    snprintf(buf, sizeof(buf), "%llu.%06llu", whole, fraction);
+    break;
+  }
+  default: {
+    unsigned long long digit = rng.below(10);
+    unsigned long long fraction = rng.below(1000000000);
+    bool negative = rng.chance(50);
+    unsigned long long exponent = rng.below(300);
+    snprintf(buf, sizeof(buf), "%llu.%llue%s%llu", digit, fraction,
+             negative ? "-" : "", exponent);
+    break;
+  }
+  }
+  out += buf;
+}
+
+string gen_numbers(Random &rng, Options const &options) {
+  string out = "[";
+  while (out.size() < options.size) {
+    if (out.size() > 1)
+      out += ",\n";
+    out += "[";
+    for (int i = 0; i < 16; i++) {
+      if (i)
+        out += ",";
+      number(rng, out);
+    }
+    out += "]";
+  }
+  return out + "]";
+}
+
+/* 一个含有转义的长字符串，大约 1/4 的字符需要转义 */
+void escaped_string(Random &rng, string &out) {
+  static const char *escapes[] = {"\\\"", "\\\\", "\\/",     "\\b",
+                                  "\\f",  "\\n",  "\\r",     "\\t",
+                                  "\\u00e9", "\\u4e2d", "\\ud83d\\ude00"};
+  size_t len = 200 + rng.below(800);
+  out += '"';
+  for (size_t i = 0; i < len; i++) {
+    if (rng.chance(25))
+      out += escapes[rng.below(sizeof(escapes) / sizeof(*escapes))];
+    else if (rng.chance(5))
+      out += "\xe4\xb8\xad"; /*不转义的 UTF-8*/
+    else
+      out += char('a' + rng.below(26));
+  }
+  out += '"';
+}
+
+string gen_escapes(Random &rng, Options const &options) {
+  string out = "[";
+  while (out.size() < options.size) {
+    if (out.size() > 1)
+      out += ",\n";
+    escaped_string(rng, out);
+  }
+  return out + "]";
+}
+
+/* 一条 depth 层深的链，list 和 dict 交替，最里面是一个数字 */
+void deep_value(Random &rng, size_t depth, string &out) {
+  for (size_t i = 0; i < depth; i++) {
+    if (i % 2) {
+      out += "{\"";
+      out += rng.word(1, 6);
+      out += "\":";
+    } else {
+      out += "[";
+    }
+  }
+  number(rng, out);
+  for (size_t i = depth; i-- > 0;)
+    out += i % 2 ? "}" : "]";
+}
+
+string gen_deep(Random &rng, Options const &options) {
+  string out = "[";
+  while (out.size() < options.size) {
+    if (out.size() > 1)
+      out += ",\n";
+    deep_value(rng, options.depth, out);
+  }
+  return out + "]";
+}
+
+string gen_wide(Random &rng, Options const &options) {
+  string out = "[";
+  while (out.size() < options.size) {
+    if (out.size() > 1)
+      out += ",\n";
+    out += "{";
+    for (size_t i = 0; i < options.width; i++) {
+      if (i)
+        out += ",";
+      /*key 不能重复，带上编号*/
+      out += "\"";
+      out += rng.word(4, 12);
+      out += "_";
+      out += std::to_string(i);
+      out += "\":";
+      if (rng.chance(50)) {
+        number(rng, out);
+      } else {
+        out += "\"";
+        out += rng.word(0, 16);
+        out += "\"";
+      }
+    }
+    out += "}";
+  }
+  return out + "]";
+}
+
+string gen_records(Random &rng, Options const &options) {
+  static const char *status[] = {"active", "pending", "disabled", "deleted"};
+  string out = "[";
+  for (size_t id = 0; out.size() < options.size; id++) {
+    if (out.size() > 1)
+      out += ",\n";
+    string name = rng.word(3, 10);
+    string domain = rng.word(4, 8);
+    const char *state = status[rng.below(4)];
+    bool verified = rng.chance(50);
+    out += "{\"id\":";
+    out += std::to_string(id);
+    out.append(",\"name\":\"").append(name);
+    out.append("\",\"email\":\"").append(name).append("@").append(domain);
+    out.append(".com\",\"status\":\"").append(state);
+    out.append("\",\"verified\":").append(verified ? "true" : "false");
+    out += ",\"score\":";
+    number(rng, out);
+    out += ",\"tags\":[";
+    for (uint64_t i = 0, n = rng.below(5); i < n; i++)
+      out.append(i ? ",\"" : "\"").append(rng.word(3, 8)).append("\"");
+    string city = rng.word(4, 10);
+    uint64_t zip = 10000 + rng.below(90000);
+    out.append("],\"address\":{\"city\":\"").append(city);
+    out.append("\",\"zip\":\"").append(std::to_string(zip));
+    out += "\",\"geo\":[";
+    number(rng, out);
+    out += ",";
+    number(rng, out);
+    string manager =
+        rng.chance(30) ? string("null") : std::to_string(rng.below(id + 1));
+    out.append("]},\"manager\":").append(manager).append("}");
+  }
+  return out + "]";
+}
+
+/* 一行或几行 // 注释 */
+void comment(Random &rng, string &out, string const &indent) {
+  for (uint64_t i = 0, n = 1 + rng.below(3); i < n; i++) {
+    out.append(indent).append("//");
+    for (uint64_t j = 0, words = 3 + rng.below(12); j < words; j++)
+      out.append(" ").append(rng.word(2, 9));
+    out += "\n";
+  }
+}
+
+string gen_comments(Random &rng, Options const &options) {
+  string out = "{\n";
+  for (size_t i = 0; out.size() < options.size; i++) {
+    if (i) { /*逗号放在上一个值后面*/
+      out.pop_back();
+      out += ",\n";
+    }
+    comment(rng, out, "  ");
+    out.append("  \"[").append(rng.word(3, 8)).append("_");
+    out.append(std::to_string(i)).append("]\": {\n");
+    for (uint64_t j = 0, n = 2 + rng.below(6); j < n; j++) {
+      comment(rng, out, "    ");
+      out.append("    \"editor.").append(rng.word(3, 10)).append("_");
+      out.append(std::to_string(j)).append("\": ");
+      if (rng.chance(40))
+        out += rng.chance(50) ? "true" : "false";
+      else if (rng.chance(50))
+        number(rng, out);
+      else
+        out.append("\"").append(rng.word(0, 20)).append("\"");
+      out += j + 1 < n ? ",\n" : "\n";
+    }
+    out += "  }\n";
+  }
+  return out + "}\n";
+}
+
+struct Shape {
+  const char *name;
+  string (*gen)(Random &, Options const &);
+};
+const Shape shapes[] = {
+    {"numbers", gen_numbers}, {"escapes", gen_escapes},
+    {"deep", gen_deep},       {"wide", gen_wide},
+    {"records", gen_records}, {"comments", gen_comments},
+};
+
+int main(int argc, char *argv[]) {
+  Options options;
+  std::vector<string> wanted;
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    if (arg == "--seed" && i + 1 < argc)
+      options.seed = std::stoull(argv[++i]);
+    else if (arg == "--size" && i + 1 < argc)
+      options.size = std::stoull(argv[++i]);
+    else if (arg == "--depth" && i + 1 < argc)
+      options.depth = std::stoull(argv[++i]);
+    else if (arg == "--width" && i + 1 < argc)
+      options.width = std::stoull(argv[++i]);
+    else if (arg == "--out" && i + 1 < argc)
+      options.out = argv[++i];
+    else if (arg.rfind("--", 0) != 0)
+      wanted.push_back(arg);
+    else {
+      std::cerr << "usage: " << argv[0]
+                << " [--seed N] [--size BYTES] [--depth N] [--width N]"
+                   " [--out DIR] [numbers|escapes|deep|wide|records|comments"
+                   " ...]\n";
+      return 1;
+    }
+  }
+  std::filesystem::create_directories(options.out);
+  for (size_t index = 0; index < std::size(shapes); index++) {
+    Shape const &shape = shapes[index];
+    if (!wanted.empty() &&
+        std::find(wanted.begin(), wanted.end(), shape.name) == wanted.end())
+      continue;
+    /*每种文件用自己的随机数，只生成其中几种时结果也不变*/
+    Random rng(options.seed + 0x9e3779b97f4a7c15ULL * (index + 1));
+    string text = shape.gen(rng, options);
+    /*生成的文件必须能被 Parser 解析*/
+    try {
+      json::Parser::FromString(text);
+    } catch (std::exception const &e) {
+      std::cerr << shape.name << ": generated invalid JSON: " << e.what()
+                << "\n";
+      return 1;
+    }
+    string path = options.out + "/" + shape.name + ".json";
+    std::ofstream fout(path, std::ios::binary);
+    fout.write(text.data(), std::streamsize(text.size()));
+    printf("%-40s %10zu bytes\n", path.c_str(), text.size());
+  }
+}
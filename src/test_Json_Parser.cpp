@@ -1,26 +1,24 @@
 /*用于测试JSON字符串的解析*/
 /*Json类*/
 #include "../include/Parser.h"
+#include "../include/Pointer.h"
+#include "../include/Snapshot.h"
+#include "../include/StreamParser.h"
 /*计时类*/
 #include "../BenchMark_Tool/Timer.cpp"
 #include "../BenchMark_Tool/scienum.cpp"
 /*sys类*/
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 using namespace json;
 
 void test_string_parser() {
-  std::ifstream fin(R"(../test_json/test.json)");
-  if (!fin) {
-    std::cout << "read file error";
-    return;
-  }
-  std::string text((std::istreambuf_iterator<char>(fin)),
-                   std::istreambuf_iterator<char>());
   /*接下来测试解析性能*/
   {
     Timer t; /*RAII封装，出作用域打印耗时*/
-    auto object = json::Parser::FromString(text);
+    /*mmap 之后直接解析，不用先读进 string*/
+    auto object = json::Parser::FromFile(R"(../test_json/test.json)");
     /*试试有没有解析成功*/
     std::cout << ((object["[css]"]["editor.suggest.insertMode"]).ToString())
               << "\n";
@@ -28,4 +26,159 @@ void test_string_parser() {
     //    fout << object.ToString();
   }
 }
-int main(int argc, char *argv[]) { test_string_parser(); }
\ No newline at end of file
+
+/*读进 string 再解析、FromFile、零拷贝的 FromFileView 三种方式的耗时*/
+void test_file_parser(std::string const &path) {
+  std::cout << path << "\n";
+  {
+    std::cout << "ifstream + FromString : ";
+    Timer t;
+    std::ifstream fin(path, std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(fin)),
+                     std::istreambuf_iterator<char>());
+    auto object = json::Parser::FromString(text);
+  }
+  {
+    std::cout << "FromFile             : ";
+    Timer t;
+    auto object = json::Parser::FromFile(path);
+  }
+  std::shared_ptr<JObject> root;
+  {
+    std::cout << "FromFileView         : ";
+    Timer t;
+    root = json::Parser::FromFileView(path);
+  }
+  /*子节点也可以单独拿出来，映射一直活到最后一个 shared_ptr 析构*/
+  std::shared_ptr<JObject> first(root, &root->Value<list_t>().front());
+  root.reset();
+  std::cout << "first element: " << first->ToString().size() << " bytes\n";
+}
+
+/*启动时解析 JSON 和打开二进制快照的对比，快照写在当前目录下*/
+void test_snapshot() {
+  auto object = json::Parser::FromFile(R"(../test_json/test.json)");
+  Snapshot::Save(object, "test.snap");
+  {
+    std::cout << "FromFile + lookup      : ";
+    Timer t;
+    auto config = json::Parser::FromFile(R"(../test_json/test.json)");
+    config["[css]"]["editor.suggest.insertMode"].Value<str_view_t>();
+  }
+  {
+    std::cout << "Snapshot::Open + lookup: ";
+    Timer t;
+    Snapshot snapshot = Snapshot::Open("test.snap");
+    snapshot.Root()["[css]"]["editor.suggest.insertMode"].Value<str_view_t>();
+  }
+  {
+    Snapshot snapshot = Snapshot::Open("test.snap");
+    std::cout << snapshot.Root()["[css]"]["editor.suggest.insertMode"]
+                     .Value<str_t>()
+              << " " << snapshot.Bytes() << " bytes, same as JSON: "
+              << (snapshot.Root().ToJObject().ToString() == object.ToString())
+              << "\n";
+  }
+  /*先关掉映射再删除，Windows 上映射着的文件删不掉*/
+  std::remove("test.snap");
+}
+
+/*同一个文件按 4KB 一块喂给 StreamParser，结果应该和上面一样*/
+void test_stream_parser() {
+  std::ifstream fin(R"(../test_json/test.json)", std::ios::binary);
+  if (!fin) {
+    std::cout << "read file error";
+    return;
+  }
+  Timer t;
+  DomBuilder builder;
+  StreamParser<DomBuilder> parser(builder);
+  char buf[4096];
+  while (fin.read(buf, sizeof(buf)) || fin.gcount() > 0)
+    parser.feed({buf, size_t(fin.gcount())});
+  parser.finish();
+  auto &object = builder.result();
+  std::cout << ((object["[css]"]["editor.suggest.insertMode"]).ToString())
+            << "\n";
+}
+/*同一条路径反复查找：预先编译好的 Pointer 和逐层 operator[] 对比*/
+void test_pointer() {
+  std::ifstream fin(R"(../test_json/test.json)");
+  if (!fin) {
+    std::cout << "read file error";
+    return;
+  }
+  std::string text((std::istreambuf_iterator<char>(fin)),
+                   std::istreambuf_iterator<char>());
+  auto object = json::Parser::FromString(text);
+  Pointer path("/[css]/editor.suggest.insertMode");
+  std::cout << path.Find(object)->ToString() << "\n";
+  constexpr int N = 100000;
+  size_t hits = 0;
+  {
+    Timer t;
+    for (int i = 0; i < N; i++)
+      hits += path.Find(object) != nullptr;
+    std::cout << "Pointer::Find x" << N << " : ";
+  }
+  {
+    Timer t;
+    for (int i = 0; i < N; i++)
+      hits += object["[css]"]["editor.suggest.insertMode"].Type() == T_STR;
+    std::cout << "operator[] x" << N << " : ";
+  }
+  /*按需解析的文档上用同一个 Pointer*/
+  LazyDocument doc(text);
+  std::cout << path.Find(doc.Root())->Value<str_t>() << " " << hits << "\n";
+}
+/*打开统计之后看一次解析、一次序列化各做了多少事情*/
+void test_stats() {
+  Instrument::Enable();
+  auto object = json::Parser::FromFile(R"(../test_json/test.json)");
+  Stats parse = Instrument::Last();
+  object.ToString();
+  Stats total = Instrument::Thread();
+  Instrument::Enable(false);
+  static const char *names[] = {"null", "bool", "int", "double",
+                                "str",  "list", "dict"};
+  std::cout << "parse: " << parse.bytes_in << " bytes, " << parse.Nodes()
+            << " nodes (";
+  for (int type = T_NULL; type <= T_DICT; type++)
+    std::cout << names[type] << " " << parse.nodes[type]
+              << (type < T_DICT ? ", " : ")");
+  std::cout << ", depth " << parse.max_depth << ", " << parse.comments
+            << " comments, " << parse.strings << " strings, "
+            << parse.bytes_allocated << " bytes allocated, "
+            << parse.parse_seconds * 1e3 << " ms\n"
+            << "this thread: " << total.parses << " parses, "
+            << total.serializes << " serializes, " << total.bytes_out
+            << " bytes out, " << total.serialize_seconds * 1e3 << " ms\n";
+}
+/*d[new] = d[old]：插入新 key 之后右边的引用还要有效，key 多到建了索引也一样*/
+void test_dict_insert() {
+  auto object = json::Parser::FromString(R"({"a":1,"b":"value"})");
+  char key[16];
+  for (int i = 0; i < 64; i++) {
+    int len = std::snprintf(key, sizeof(key), "k%d", i);
+    object[std::string_view(key, len)] = object["b"];
+  }
+  auto &dict = object.Value<dict_t>();
+  size_t same = 0;
+  for (auto &[key, value] : dict)
+    same += value.Type() == T_STR && value.Value<str_t>() == "value";
+  std::cout << "dict insert: " << dict.size() << " keys, " << same
+            << " copies of b\n";
+  if (dict.size() != 66 || same != 65)
+    throw std::logic_error("dict entries moved on insert");
+}
+int main(int argc, char *argv[]) {
+  test_string_parser();
+  test_stream_parser();
+  test_pointer();
+  test_snapshot();
+  test_stats();
+  test_dict_insert();
+  /*large-file.json 需要自己下载，没有的话跳过*/
+  if (std::ifstream(R"(../test_json/large-file.json)"))
+    test_file_parser(R"(../test_json/large-file.json)");
+}
\ No newline at end of file
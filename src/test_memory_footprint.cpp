@@ -0,0 +1,168 @@
+/*用于对比 JObject 新旧两种内存布局的内存占用*/
+#include "../BenchMark_Tool/AllocCounter.h"
+#include "../BenchMark_Tool/Timer.cpp"
+#include "../include/Parser.h"
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+using namespace json;
+
+/* 旧的布局：TYPE 标记 + variant，dict 直接放在节点里 */
+struct LegacyJObject {
+  using value_t =
+      std::variant<bool, int32_t, double, std::string,
+                   std::vector<LegacyJObject>,
+                   std::unordered_map<std::string, LegacyJObject>>;
+  TYPE m_type;
+  value_t m_value;
+};
+
+/* 解析时堆上分配的次数和字节数 */
+struct HeapUsage {
+  size_t count;
+  size_t bytes;
+};
+std::ostream &operator<<(std::ostream &out, HeapUsage usage) {
+  return out << usage.count << " allocs, " << usage.bytes << " bytes";
+}
+template <class F> HeapUsage heap_usage(F &&parse) {
+  size_t count = alloc_counter::g_count, bytes = alloc_counter::g_bytes;
+  auto obj = parse();
+  return {alloc_counter::g_count - count, alloc_counter::g_bytes - bytes};
+}
+
+/* 统计节点个数 */
+struct NodeCount {
+  size_t total = 0;
+  size_t scalar = 0;
+  size_t str = 0;
+  size_t inline_str = 0; /*直接放在节点里的短字符串*/
+};
+
+/* 把新布局的树按原样转成旧布局的树 */
+LegacyJObject to_legacy(JObject &obj, NodeCount &cnt) {
+  cnt.total++;
+  switch (obj.Type()) {
+  case T_NULL:
+    cnt.scalar++;
+    return {T_NULL, std::string("null")};
+  case T_BOOL:
+    cnt.scalar++;
+    return {T_BOOL, obj.Value<bool_t>()};
+  case T_INT:
+    cnt.scalar++;
+    return {T_INT, obj.Value<int32_t>()};
+  case T_DOUBLE:
+    cnt.scalar++;
+    return {T_DOUBLE, obj.Value<double_t>()};
+  case T_STR:
+    cnt.str++;
+    if (obj.Value<str_view_t>().size() <= JObject::inline_size)
+      cnt.inline_str++;
+    return {T_STR, obj.Value<str_t>()};
+  case T_LIST: {
+    std::vector<LegacyJObject> list;
+    list.reserve(obj.Value<list_t>().size());
+    for (auto &item : obj.Value<list_t>())
+      list.push_back(to_legacy(item, cnt));
+    return {T_LIST, std::move(list)};
+  }
+  case T_DICT: {
+    std::unordered_map<std::string, LegacyJObject> dict;
+    for (auto &[key, value] : obj.Value<dict_t>()) {
+      cnt.str++;
+      if (key.size() <= DictKey::inline_size)
+        cnt.inline_str++;
+      dict.emplace(std::string(key), to_legacy(value, cnt));
+    }
+    return {T_DICT, std::move(dict)};
+  }
+  }
+  return {};
+}
+
+void test_footprint(char const *path) {
+  std::ifstream fin(path);
+  if (!fin) {
+    std::cout << "read file error";
+    return;
+  }
+  std::string text((std::istreambuf_iterator<char>(fin)),
+                   std::istreambuf_iterator<char>());
+  /*vscode_comment.json 末尾多了一个逗号*/
+  auto parsed = Parser::FromString(text, SYNTAX_JSONC);
+  /* 两边都用"刚好够用"的拷贝来统计，排除 vector 扩容带来的浪费 */
+  NodeCount cnt;
+  size_t before = alloc_counter::g_bytes;
+  LegacyJObject legacy = to_legacy(parsed, cnt);
+  size_t legacy_bytes = alloc_counter::g_bytes - before;
+  before = alloc_counter::g_bytes;
+  JObject compact = parsed;
+  size_t compact_bytes = alloc_counter::g_bytes - before;
+
+  std::cout << path << "\n";
+  std::cout << "nodes : " << cnt.total << " (scalars: " << cnt.scalar
+            << ")\n";
+  std::cout << "sizeof(node)  old: " << sizeof(LegacyJObject)
+            << " bytes, new: " << sizeof(JObject) << " bytes\n";
+  std::cout << "heap bytes    old: " << legacy_bytes
+            << " bytes, new: " << compact_bytes << " bytes\n";
+  std::cout << "keys+strings  : " << cnt.str << " (stored inline: "
+            << cnt.inline_str << ")\n";
+  std::cout << "FromString    : "
+            << heap_usage([&] {
+                 return Parser::FromString(text, SYNTAX_JSONC);
+               })
+            << "\n";
+  std::cout << "FromString x100 : ";
+  {
+    Timer t;
+    for (int i = 0; i < 100; i++)
+      Parser::FromString(text, SYNTAX_JSONC);
+  }
+}
+
+/* 同一种格式的记录组成的数组：key 全都一样，status/category 只有几种取值 */
+void test_intern(size_t records) {
+  /* 值都是 13~16 字节：不超过 JObject::inline_size 的会直接放在节点里，
+   * 不进 intern 表，那样就测不到值的 intern 了 */
+  static char const *status[] = {"account_active", "account_inactive",
+                                 "account_pending"};
+  static char const *category[] = {"electronics_dept", "books_and_media",
+                                   "garden_supplies", "toys_and_games"};
+  std::string text = "[";
+  for (size_t i = 0; i < records; i++) {
+    if (i)
+      text += ',';
+    text += R"({"identifier":)" + std::to_string(i) +
+            R"(,"display_name":"user_)" + std::to_string(i) +
+            R"(","account_status":")" + status[i % 3] +
+            R"(","product_category":")" + category[i % 4] +
+            R"(","is_verified_account":)" + (i % 2 ? "true" : "false") +
+            "}";
+  }
+  text += "]";
+
+  InternTable keys, values(16);
+  HeapUsage plain = heap_usage([&] { return Parser::FromString(text); });
+  HeapUsage first = heap_usage([&] { return Parser::FromString(text, keys); });
+  /* 表留着解析下一个同样格式的文档 */
+  HeapUsage warm = heap_usage([&] { return Parser::FromString(text, keys); });
+  heap_usage([&] { return Parser::FromString(text, values); });
+  HeapUsage warm_values =
+      heap_usage([&] { return Parser::FromString(text, values); });
+
+  std::cout << records << " records (" << text.size() << " bytes)\n";
+  std::cout << "no intern             : " << plain << "\n";
+  std::cout << "keys, first parse     : " << first << "\n";
+  std::cout << "keys, table reused    : " << warm << "\n";
+  std::cout << "keys+values, reused   : " << warm_values << "\n";
+}
+
+int main(int argc, char *argv[]) {
+  test_footprint(R"(../test_json/vscode_comment.json)");
+  test_footprint(R"(../test_json/test.json)");
+  test_intern(10000);
+}
@@ -1,71 +1,234 @@
-/*用于测试JSON字符串的解析*/
-#include "../BenchMark_Tool/Timer.cpp"
-#include "../BenchMark_Tool/scienum.cpp"
+/*解析速度的基准测试：test_json（或者 --dir 指定的目录）下的每个文件，分别测解析、访问、序列化、析构，
+ * 以及零拷贝、Document、SAX、按需解析和 rapidJSON、simdjson 的解析。
+ * 用法：MyJson_Parser_benchmark [--quick] [--dir 目录] [--json 结果.json]
+ *                               [--csv 结果.csv] [--baseline 上一次的结果.json]
+ * --dir 可以是 MyJson_Parser_corpus 生成的目录，看不同结构的文件各慢在哪里。
+ * 有 --baseline 时按中位数和上一次的结果比较，慢了超过 10% 的会标出来。*/
+#include "../BenchMark_Tool/Bench.h"
+#include "../include/Document.h"
+#include "../include/Lazy.h"
 #include "../include/Parser.h"
 #include "../other_include/rapidJson/document.h"
 #include "../other_include/simdjson/simdjson.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
-using std::cout;
-using std::endl;
-using std::istreambuf_iterator;
+#include <map>
+#include <string>
+#include <vector>
 using std::string;
 
-void test_rapidJSON(std::ifstream &fin) {
-  if (!fin) {
-    std::cerr << "无法打开文件" << std::endl;
-    return;
+/* 遍历整棵树，每个节点都访问一次 */
+size_t visit(json::JObject &object) {
+  switch (object.Type()) {
+  case json::T_STR:
+    return object.Value<json::str_view_t>().size();
+  case json::T_LIST: {
+    size_t n = 1;
+    for (auto &item : object.Value<json::list_t>())
+      n += visit(item);
+    return n;
   }
-  // 将文件内容读入字符串
-  string json_str((istreambuf_iterator<char>(fin)),
-                  istreambuf_iterator<char>());
-  // 创建一个 Document 对象，用于解析 JSON
-  rapidjson::Document doc;
-  {
-    Timer t;
-    doc.Parse(json_str.c_str());
-    cout << "rapidJSON : ";
+  case json::T_DICT: {
+    size_t n = 1;
+    for (auto &[key, item] : object.Value<json::dict_t>())
+      n += key.size() + visit(item);
+    return n;
+  }
+  default:
+    return 1;
   }
 }
 
-void test_MyJSON(std::ifstream &fin) {
-  if (!fin) {
-    std::cout << "read file error";
-    return;
+/* 事件模式：只数一数有多少个 dict，不构建 JObject 树 */
+struct CountHandler : json::BaseHandler {
+  size_t objects = 0;
+  void start_object() { objects++; }
+};
+
+/**
+ * 一个文件的所有测试
+ * @param file 文件名，只用来打印
+ * @param text 文件的内容
+ */
+void bench_file(string const &file, string const &text,
+                bench::Options const &options,
+                std::vector<bench::Result> &results) {
+  size_t bytes = text.size();
+  /*严格模式解析不了的（比如末尾多一个逗号的 vscode 配置）按 JSONC 解析*/
+  json::SYNTAX syntax = json::SYNTAX_STRICT;
+  try {
+    json::Parser::FromString(text);
+  } catch (std::logic_error const &) {
+    syntax = json::SYNTAX_JSONC;
   }
-  std::string text((std::istreambuf_iterator<char>(fin)),
-                   std::istreambuf_iterator<char>());
-  /*测试MyJSONParser*/
-  {
-    Timer t; /*RAII封装，出作用域打印耗时*/
-    auto object = json::Parser::FromString(text);
-    /*试试有没有解析成功*/
-    //    std::cout <<
-    //    ((object["[css]"]["editor.suggest.insertMode"]).ToString())
-    //              << "\n";
-    std::cout << "MyJsonParser : ";
+  auto add = [&](bench::Result result) {
+    bench::print(result);
+    results.push_back(std::move(result));
+  };
+  /*解析：只量解析，结果在量完之后才析构*/
+  add(bench::run(file, "parse", bytes, [&] {
+    double start = bench::now();
+    auto object = json::Parser::FromString(text, syntax);
+    double cost = bench::now() - start;
+    bench::keep(object);
+    return cost;
+  }, options));
+  auto object = json::Parser::FromString(text, syntax);
+  add(bench::run(file, "access", bytes, [&] {
+    size_t n = visit(object);
+    bench::keep(n);
+  }, options));
+  add(bench::run(file, "serialize", bytes, [&] {
+    double start = bench::now();
+    string out = object.ToString();
+    double cost = bench::now() - start;
+    bench::keep(out);
+    return cost;
+  }, options));
+  /*析构：只量整棵树的释放*/
+  add(bench::run(file, "destroy", bytes, [&] {
+    auto dead = json::Parser::FromString(text, syntax);
+    double start = bench::now();
+    { auto moved = std::move(dead); }
+    return bench::now() - start;
+  }, options));
+  /*零拷贝模式：字符串值直接指向 text*/
+  add(bench::run(file, "parse(zero-copy)", bytes, [&] {
+    double start = bench::now();
+    auto view = json::Parser::FromStringView(text, syntax);
+    double cost = bench::now() - start;
+    bench::keep(view);
+    return cost;
+  }, options));
+  /*解析到 Document 里：所有节点从 arena 分配，一次性释放，这里连释放一起量*/
+  add(bench::run(file, "parse(document)", bytes, [&] {
+    json::Document doc;
+    bench::keep(doc.Parse(text, nullptr, syntax));
+  }, options));
+  add(bench::run(file, "parse(sax)", bytes, [&] {
+    CountHandler handler;
+    json::Parser::FromString(text, handler, syntax);
+    bench::keep(handler.objects);
+  }, options));
+  /*按需解析：只取顶层的元素个数，其余的全部跳过*/
+  json::TYPE root = json::LazyDocument(text, syntax).Root().Type();
+  if (root == json::T_LIST || root == json::T_DICT)
+    add(bench::run(file, "lazy(size)", bytes, [&] {
+      json::LazyDocument doc(text, syntax);
+      bench::keep(doc.Root().Size());
+    }, options));
+
+  /*对照：rapidJSON 和 simdjson 的完整解析（不支持注释的文件跳过）*/
+  constexpr unsigned flags =
+      rapidjson::kParseCommentsFlag | rapidjson::kParseTrailingCommasFlag;
+  if (!rapidjson::Document().Parse<flags>(text.c_str()).HasParseError())
+    add(bench::run(file, "rapidJSON", bytes, [&] {
+      rapidjson::Document doc;
+      doc.Parse<flags>(text.c_str());
+      bench::keep(doc);
+    }, options));
+  simdjson::padded_string padded(text);
+  simdjson::dom::parser parser;
+  simdjson::dom::element element;
+  if (!parser.parse(padded).get(element))
+    add(bench::run(file, "simdjson(dom)", bytes, [&] {
+      simdjson::dom::element doc;
+      bench::keep(parser.parse(padded).get(doc));
+    }, options));
+}
+
+/**
+ * 和上一次的结果比较中位数
+ * @param path 上一次 --json 写出来的文件
+ * @param results 这一次的结果
+ */
+void compare(string const &path, std::vector<bench::Result> const &results) {
+  auto baseline = json::Parser::FromFile(path);
+  std::map<string, double> old;
+  for (auto &item : baseline.Value<json::list_t>())
+    old[item["file"].Value<json::str_t>() + " " +
+        item["name"].Value<json::str_t>()] = item["median"].Value<double>();
+  printf("\n%-24s %-28s %12s %12s %8s\n", "file", "name", "old(ms)",
+         "new(ms)", "change");
+  size_t slower = 0;
+  for (auto &r : results) {
+    auto it = old.find(r.file + " " + r.name);
+    if (it == old.end())
+      continue;
+    double change = (r.median - it->second) / it->second * 100;
+    bool regression = change > 10;
+    slower += regression;
+    printf("%-24s %-28s %12.3f %12.3f %+7.1f%%%s\n", r.file.c_str(),
+           r.name.c_str(), it->second * 1e3, r.median * 1e3, change,
+           regression ? "  <-- slower" : "");
   }
+  printf("%zu results slower than the baseline by more than 10%%\n", slower);
 }
-void test_simdJson(std::ifstream &fin) {
 
-  if (!fin) {
+int main(int argc, char *argv[]) {
+  bench::Options options;
+  string dir = "../test_json", json_path, csv_path, baseline;
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    if (arg == "--quick") { /*只看一眼，不够稳定*/
+      options.warmup = 1;
+      options.min_runs = 3;
+      options.min_seconds = 0;
+    } else if (arg == "--dir" && i + 1 < argc) {
+      dir = argv[++i];
+    } else if (arg == "--json" && i + 1 < argc) {
+      json_path = argv[++i];
+    } else if (arg == "--csv" && i + 1 < argc) {
+      csv_path = argv[++i];
+    } else if (arg == "--baseline" && i + 1 < argc) {
+      baseline = argv[++i];
+    } else {
+      std::cerr << "usage: " << argv[0]
+                << " [--quick] [--dir DIR] [--json out.json] [--csv out.csv]"
+                   " [--baseline old.json]\n";
+      return 1;
+    }
+  }
+  /*目录下所有的 .json 文件，按文件名排序，每个文件单独读一遍*/
+  std::vector<std::filesystem::path> files;
+  std::error_code error;
+  for (auto &entry : std::filesystem::directory_iterator(dir, error))
+    if (entry.path().extension() == ".json")
+      files.push_back(entry.path());
+  std::sort(files.begin(), files.end());
+  if (files.empty()) {
     std::cout << "read file error";
-    return;
+    return 1;
+  }
+  std::vector<bench::Result> results;
+  bench::print_header();
+  for (auto &path : files) {
+    std::ifstream fin(path, std::ios::binary);
+    string text((std::istreambuf_iterator<char>(fin)),
+                std::istreambuf_iterator<char>());
+    bench_file(path.filename().string(), text, options, results);
   }
-  using namespace simdjson;
-  ondemand::parser parser;
-  padded_string json = padded_string::load(R"(../test_json/large-file.json)") ;
-  {
-    Timer t;
-    ondemand::document  j = parser.iterate(json);
-    cout<<"simdjson : ";
+  if (!json_path.empty()) {
+    FILE *out = fopen(json_path.c_str(), "w");
+    if (out == nullptr) {
+      std::cerr << "can not write " << json_path << "\n";
+      return 1;
+    }
+    bench::write_json(out, results);
+    fclose(out);
   }
+  if (!csv_path.empty()) {
+    FILE *out = fopen(csv_path.c_str(), "w");
+    if (out == nullptr) {
+      std::cerr << "can not write " << csv_path << "\n";
+      return 1;
+    }
+    bench::write_csv(out, results);
+    fclose(out);
+  }
+  if (!baseline.empty())
+    compare(baseline, results);
 }
-int main(int argc, char *argv[]) {
-  /*读取文件*/
-  std::ifstream ifs(R"(../test_json/large-file.json)");
-  test_MyJSON(ifs);
-  test_rapidJSON(ifs);
-  test_simdJson(ifs);
-  //  test_nlohmannJSON(ifs); 这个解析时，说JSON格式错误，可能是标准不一样吧
-}
\ No newline at end of file
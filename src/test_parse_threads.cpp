@@ -0,0 +1,223 @@
+/*多线程同时调用 Parser::FromString 的吞吐量测试，以及 NDJSON、大文档的并行解析、
+ * 解析结果的缓存*/
+/*Json类*/
+#include "../include/DocumentCache.h"
+#include "../include/NdJson.h"
+#include "../include/ParallelParser.h"
+#include "../include/Parser.h"
+/*sys类*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+using namespace json;
+
+/*test_json 下的文件，不存在的跳过。vscode_comment.json 末尾多了一个逗号，
+ * 所以这里都按 SYNTAX_JSONC 解析*/
+std::vector<std::string> load_corpus() {
+  std::vector<std::string> corpus;
+  for (auto name : {"test.json", "vscode_comment.json",
+                    "vscode_Nocomment.json", "large-file.json"}) {
+    std::ifstream fin(std::string("../test_json/") + name, std::ios::binary);
+    if (!fin)
+      continue;
+    corpus.emplace_back(std::istreambuf_iterator<char>(fin),
+                        std::istreambuf_iterator<char>());
+  }
+  return corpus;
+}
+
+/*顶层 list/dict 的元素个数，用来检查解析结果*/
+size_t top_size(JObject const &object) {
+  return object.Type() == T_LIST ? object.Value<list_t>().size()
+                                 : object.Value<dict_t>().size();
+}
+
+/**
+ * threads 个线程同时解析，每个线程把整个 corpus 解析 rounds 遍
+ * @return 耗时（秒）
+ */
+double run(std::vector<std::string> const &corpus,
+           std::vector<size_t> const &expect, int threads, int rounds) {
+  std::atomic<int> errors{0};
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&] {
+      for (int r = 0; r < rounds; r++)
+        for (size_t i = 0; i < corpus.size(); i++) {
+          auto object = Parser::FromString(corpus[i], SYNTAX_JSONC);
+          /*结果被别的线程破坏的话，元素个数就对不上了*/
+          if (top_size(object) != expect[i])
+            errors++;
+        }
+    });
+  }
+  for (auto &worker : workers)
+    worker.join();
+  std::chrono::duration<double> cost = std::chrono::steady_clock::now() - start;
+  if (errors != 0)
+    std::cout << "ERROR: " << errors << " wrong results\n";
+  return cost.count();
+}
+
+/*第 i 条日志记录*/
+std::string make_record(size_t i) {
+  return R"({"ts":)" + std::to_string(1700000000 + i) + R"(,"level":")" +
+         (i % 10 ? "info" : "error") +
+         R"(","msg":"request handled","path":"/api/v1/items/)" +
+         std::to_string(i % 1000) + R"(","latency_ms":)" +
+         std::to_string(i % 97) + ".5}";
+}
+
+/**
+ * 生成 lines 行的 NDJSON 日志，中间夹一行坏掉的
+ */
+std::string make_ndjson(size_t lines) {
+  std::string text;
+  for (size_t i = 0; i < lines; i++)
+    text += (i == lines / 2 ? std::string("{\"broken\": ") : make_record(i)) +
+            "\n";
+  return text;
+}
+
+/* NdJsonReader 在不同线程数下的吞吐量，坏掉的那一行跳过 */
+void test_ndjson(int max_threads) {
+  std::string text = make_ndjson(200000);
+  double mb = double(text.size()) / (1024 * 1024);
+  double base = 0;
+  for (bool ordered : {true, false}) {
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+      NdJsonReader::Options options;
+      options.threads = threads;
+      options.ordered = ordered;
+      options.skip_errors = true;
+      NdJsonReader reader(options);
+      size_t errors = 0;
+      auto start = std::chrono::steady_clock::now();
+      size_t values = reader.Read(
+          text, [](size_t, JObject &) {},
+          [&](size_t, string_view, std::string const &) { errors++; });
+      std::chrono::duration<double> cost =
+          std::chrono::steady_clock::now() - start;
+      if (base == 0)
+        base = mb / cost.count();
+      printf("ndjson %-9s %2d threads : %8.1f MB/s  (x%.2f)  %zu values, "
+             "%zu skipped\n",
+             ordered ? "ordered" : "unordered", threads, mb / cost.count(),
+             mb / cost.count() / base, values, errors);
+      fflush(stdout);
+    }
+  }
+}
+
+/**
+ * ParallelParser 解析一个很大的数组：有 large-file.json 就用它，
+ * 没有的话用 200000 条日志记录拼成的数组
+ */
+void test_parallel_parse(std::vector<std::string> const &corpus,
+                         int max_threads) {
+  std::string text;
+  for (auto &content : corpus)
+    if (content.size() > text.size() && content.front() == '[')
+      text = content;
+  if (text.size() < (size_t(1) << 20)) {
+    text = "[";
+    for (size_t i = 0; i < 200000; i++)
+      text += (i ? ",\n" : "") + make_record(i);
+    text += "]";
+  }
+  double mb = double(text.size()) / (1024 * 1024);
+  double base = 0;
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    ParallelParser::Options options;
+    options.threads = threads;
+    ParallelParser parser(options);
+    auto start = std::chrono::steady_clock::now();
+    JObject object = parser.Parse(text);
+    std::chrono::duration<double> cost =
+        std::chrono::steady_clock::now() - start;
+    if (base == 0)
+      base = mb / cost.count();
+    printf("parallel  %2d threads : %8.1f MB/s  (x%.2f)  %zu elements\n",
+           threads, mb / cost.count(), mb / cost.count() / base,
+           top_size(object));
+    fflush(stdout);
+  }
+}
+
+/**
+ * 几个线程反复加载同样的配置：每次都解析，和用 DocumentCache 对比
+ */
+void test_cache(std::vector<std::string> const &corpus, int threads) {
+  constexpr int N = 200;
+  std::vector<std::string> configs;
+  for (auto &content : corpus)
+    if (content.size() < (size_t(1) << 20))
+      configs.push_back(content);
+  DocumentCache cache(size_t(64) << 20, SYNTAX_JSONC);
+  for (bool cached : {false, true}) {
+    cache.Clear();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    std::atomic<size_t> visited{0};
+    for (int t = 0; t < threads; t++)
+      workers.emplace_back([&] {
+        size_t n = 0;
+        for (int i = 0; i < N; i++)
+          for (auto &config : configs) {
+            /*缓存返回的是 const 的文档，直接用 const 的 Value<>() 读*/
+            if (cached)
+              n += top_size(*cache.FromString(config));
+            else
+              n += top_size(Parser::FromString(config, SYNTAX_JSONC));
+          }
+        visited += n;
+      });
+    for (auto &worker : workers)
+      worker.join();
+    std::chrono::duration<double> cost =
+        std::chrono::steady_clock::now() - start;
+    auto stats = cache.Counters();
+    printf("%-10s %2d threads : %10.0f loads/s  (hits %zu, misses %zu, "
+           "%zu KB cached, %zu top-level items read)\n",
+           cached ? "cache" : "no cache", threads,
+           double(N) * threads * configs.size() / cost.count(), stats.hits,
+           stats.misses, stats.bytes / 1024, visited.load());
+    fflush(stdout);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  auto corpus = load_corpus();
+  if (corpus.empty()) {
+    std::cout << "read file error";
+    return 1;
+  }
+  size_t bytes = 0;
+  std::vector<size_t> expect;
+  for (auto &text : corpus) {
+    bytes += text.size();
+    auto object = Parser::FromString(text, SYNTAX_JSONC);
+    expect.push_back(top_size(object));
+  }
+  int rounds = argc > 1 ? std::atoi(argv[1]) : 5;
+  int max_threads = std::max(2u, std::thread::hardware_concurrency());
+  run(corpus, expect, 1, 1); /*预热*/
+  double base = 0;
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    double cost = run(corpus, expect, threads, rounds);
+    double mb = double(bytes) * threads * rounds / (1024 * 1024);
+    if (threads == 1)
+      base = mb / cost;
+    printf("%2d threads : %8.1f MB/s  (x%.2f)\n", threads, mb / cost,
+           mb / cost / base);
+    fflush(stdout);
+  }
+  test_ndjson(max_threads);
+  test_parallel_parse(corpus, max_threads);
+  test_cache(corpus, max_threads);
+}
@@ -1,6 +1,8 @@
 /*用于测试反序列化与序列化*/
 /*Json类*/
 #include "../include/Parser.h"
+/*计时类*/
+#include "../BenchMark_Tool/Timer.cpp"
 /*sys类*/
 #include <iostream>
 using namespace json;
@@ -37,6 +39,27 @@ struct Mytest {
   END_FROM_JSON
 };
 
+/*不用宏：用 json_fields 在编译期描述成员，序列化时直接写成 JSON 文本*/
+struct ReflectBase {
+  int pp{};
+  string qq{};
+  static constexpr auto json_fields =
+      json::fields(json::field<"pp">(&ReflectBase::pp),
+                   json::field<"qq">(&ReflectBase::qq));
+};
+
+struct ReflectTest {
+  int id{};
+  std::string name{};
+  ReflectBase base{};
+  std::vector<int> scores{};
+  static constexpr auto json_fields =
+      json::fields(json::field<"base">(&ReflectTest::base),
+                   json::field<"id">(&ReflectTest::id),
+                   json::field<"name">(&ReflectTest::name),
+                   json::field<"scores">(&ReflectTest::scores));
+};
+
 void test_class_serialization() {
   Mytest test{.id = 32, .name = "fda"}; /*先创建一个struct*/
                                         /*测试反序列化*/
@@ -47,4 +70,55 @@ void test_class_serialization() {
   std::cout << Parser::ToJSON(item);
 }
 
-int main(int argc, char *argv[]) { test_class_serialization(); }
\ No newline at end of file
+void test_reflect_serialization() {
+  ReflectTest test{.id = 32,
+                   .name = "fda",
+                   .base = ReflectBase{0, ""},
+                   .scores = {1, 2}};
+  std::cout << "\n" << Parser::ToJSON(test) << "\n";
+  /*和宏的版本对比耗时*/
+  Mytest old{.id = 32, .name = "fda", .q = {0, ""}};
+  constexpr int N = 100000;
+  size_t size = 0;
+  {
+    Timer t;
+    for (int i = 0; i < N; i++)
+      size += Parser::ToJSON(old).size();
+    std::cout << "macro ToJSON x" << N << " : ";
+  }
+  {
+    Timer t;
+    for (int i = 0; i < N; i++)
+      size += Parser::ToJSON(test).size();
+    std::cout << "reflect ToJSON x" << N << " : ";
+  }
+}
+
+/*反序列化：宏的版本先解析成 JObject 再逐个取出来，
+ * json_fields 的版本直接从 token 流填充成员，不认识的 key 直接跳过*/
+void test_reflect_deserialization() {
+  constexpr auto text =
+      R"({"base":{"pp":0,"qq":""},"id":32,"name":"fda","scores":[1,2]})";
+  auto item = Parser::FromJson<ReflectTest>(text);
+  std::cout << Parser::ToJSON(item) << "\n";
+  constexpr int N = 100000;
+  size_t size = 0;
+  {
+    Timer t;
+    for (int i = 0; i < N; i++)
+      size += Parser::FromJson<Mytest>(text).id;
+    std::cout << "macro FromJson x" << N << " : ";
+  }
+  {
+    Timer t;
+    for (int i = 0; i < N; i++)
+      size += Parser::FromJson<ReflectTest>(text).id;
+    std::cout << "reflect FromJson x" << N << " : ";
+  }
+}
+
+int main(int argc, char *argv[]) {
+  test_class_serialization();
+  test_reflect_serialization();
+  test_reflect_deserialization();
+}
\ No newline at end of file